@@ -20,6 +20,7 @@ public class ObjectPoolingSystemPlugin : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"AIModule",
 			}
 		);
 	}
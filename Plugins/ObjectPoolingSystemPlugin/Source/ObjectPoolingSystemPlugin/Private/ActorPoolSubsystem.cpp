@@ -3,8 +3,21 @@
 
 #include "ActorPoolSubsystem.h"
 
+#include "ActorPoolTravelSubsystem.h"
 #include "LogObjectPoolingSystem.h"
+#include "ObjectPoolingSystemStats.h"
 #include "PoolableActor.h"
+#include "PoolablePawn.h"
+
+#include "AIController.h"
+#include "BrainComponent.h"
+
+#include "Components/SkeletalMeshComponent.h"
+
+#include "Engine/GameInstance.h"
+
+#include "GameFramework/Character.h"
+#include "GameFramework/PawnMovementComponent.h"
 
 #include "Logging/StructuredLog.h"
 
@@ -75,6 +88,15 @@ void UActorPoolSubsystem::PopulatePool(UWorld* World, TSubclassOf<AActor> ActorC
 	{
 		if (AActor* Actor = World->SpawnActor<AActor>(ActorClass, FTransform::Identity, Params))
 		{
+			// Spawned Actors went through BeginPlay as active ones, they're released like any other
+			if (IPoolableActor* PoolableActor = Cast<IPoolableActor>(Actor))
+			{
+				PoolableActor->ReleasedToPool();
+			}
+			if (APawn* Pawn = Cast<APawn>(Actor); Pawn && Cast<IPoolablePawn>(Pawn))
+			{
+				ReleasePooledPawn(Pawn);
+			}
 			PooledActors.Add(Actor);
 		}
 	}
@@ -104,13 +126,20 @@ AActor* UActorPoolSubsystem::SpawnOrAcquireFromPool(
 		if (FActorPool* Pool = Subsystem->Pools.Find(ActorClass); Pool && !Pool->FreeActors.IsEmpty())
 		{
 			AActor* Actor = Pool->FreeActors.Pop(false);
+			INC_DWORD_STAT(STAT_ObjectPoolingSystem_Acquired);
 
 			if (IsLoggingEnabled())
 			{
-				UE_LOGFMT(LogObjectPoolingSystem, Display, "Reusing Actor {Name} of Class {Class}", Actor->GetName(),
-				          ActorClass->GetName());
+				LogAcquired(Actor, true);
 			}
 
+			if (IPoolablePawn* PoolablePawn = Cast<IPoolablePawn>(Actor))
+			{
+				if (APawn* Pawn = Cast<APawn>(Actor))
+				{
+					AcquirePooledPawn(Pawn, PoolablePawn, SpawnTransform);
+				}
+			}
 			if (IPoolableActor* PoolableActor = Cast<IPoolableActor>(Actor))
 			{
 				PoolableActor->AcquiredFromPool(SpawnTransform, SpawnParams.Owner);
@@ -119,10 +148,10 @@ AActor* UActorPoolSubsystem::SpawnOrAcquireFromPool(
 		}
 	}
 	AActor* Actor = World->SpawnActor<AActor>(ActorClass, SpawnTransform, SpawnParams);
+	INC_DWORD_STAT(STAT_ObjectPoolingSystem_Spawned);
 	if (IsLoggingEnabled())
 	{
-		UE_LOGFMT(LogObjectPoolingSystem, Display, "Spawning new Actor {Name} of Class {Class}.", Actor->GetName(),
-		          ActorClass->GetName());
+		LogAcquired(Actor, false);
 	}
 	return Actor;
 }
@@ -138,13 +167,18 @@ void UActorPoolSubsystem::DestroyOrReleaseToPool(UWorld* World, AActor* Actor)
 		{
 			PoolableActor->ReleasedToPool();
 		}
+		if (APawn* Pawn = Cast<APawn>(Actor); Pawn && Cast<IPoolablePawn>(Pawn))
+		{
+			ReleasePooledPawn(Pawn);
+		}
 		UActorPoolSubsystem* Subsystem = World->GetSubsystem<UActorPoolSubsystem>();
 		auto& [Pool] = Subsystem->Pools.FindOrAdd(Actor->GetClass());
 		checkfSlow(!Pool.Contains(Actor), TEXT("Actor already released to the pool!"));
 		Pool.Add(Actor);
+		INC_DWORD_STAT(STAT_ObjectPoolingSystem_Released);
 		if (IsLoggingEnabled())
 		{
-			UE_LOGFMT(LogObjectPoolingSystem, Display, "Released Actor {Name} to the class pool.", Actor->GetName());
+			LogReleased(Actor);
 		}
 	}
 	else
@@ -249,3 +283,260 @@ void UActorPoolSubsystem::LogStats(UWorld* World)
 		);
 	}
 }
+
+void UActorPoolSubsystem::SetPersistentAcrossTravel(UWorld* World, TSubclassOf<AActor> ActorClass, bool IsPersistent)
+{
+	check(World);
+	check(ActorClass);
+
+	const UGameInstance* GameInstance = World->GetGameInstance();
+	checkf(GameInstance, TEXT("Pools can persist across travel only in Worlds owned by a GameInstance."));
+	UActorPoolTravelSubsystem* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+	if (IsPersistent)
+	{
+		TravelSubsystem->PersistentClasses.Add(ActorClass);
+	}
+	else
+	{
+		TravelSubsystem->PersistentClasses.Remove(ActorClass);
+		TravelSubsystem->PrewarmSnapshot.Remove(ActorClass);
+	}
+
+	if (IsLoggingEnabled())
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "Pool of Class {Class} persistent across travel: {Persistent}.",
+		          ActorClass->GetName(), IsPersistent);
+	}
+}
+
+void UActorPoolSubsystem::AddSeamlessTravelActors(UWorld* World, bool IsToTransition, TArray<AActor*>& ActorList)
+{
+	check(World);
+
+	const UGameInstance* GameInstance = World->GetGameInstance();
+	if (!GameInstance || !IsPoolingEnabled())
+	{
+		return;
+	}
+
+	UActorPoolTravelSubsystem* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+	int32 TravelingActors = 0;
+
+	// Second hop: World is the transition map, the Actors it has carried go on to the destination
+	if (!IsToTransition && TravelSubsystem->IsInTransition)
+	{
+		TravelSubsystem->IsInTransition = false;
+		for (const TWeakObjectPtr<AActor>& TravelingActor : TravelSubsystem->TravelingActors)
+		{
+			if (AActor* Actor = TravelingActor.Get())
+			{
+				ActorList.Add(Actor);
+				++TravelingActors;
+			}
+		}
+
+		if (IsLoggingEnabled())
+		{
+			UE_LOGFMT(LogObjectPoolingSystem, Display, "{Count} pooled Actors will travel on from transition World {Name}.",
+			          TravelingActors, World->GetName());
+		}
+		return;
+	}
+
+	TravelSubsystem->IsInTransition = IsToTransition;
+	TravelSubsystem->TravelingActors.Reset();
+	UActorPoolSubsystem* Subsystem = World->GetSubsystem<UActorPoolSubsystem>();
+	for (const auto& [Class, Pool] : Subsystem->Pools)
+	{
+		if (!TravelSubsystem->IsPersistentClass(Class))
+		{
+			continue;
+		}
+
+		ActorList.Append(Pool.FreeActors);
+		TravelSubsystem->TravelingActors.Append(Pool.FreeActors);
+		TravelingActors += Pool.FreeActors.Num();
+	}
+
+	if (IsLoggingEnabled())
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "{Count} pooled Actors will travel from World {Name}.",
+		          TravelingActors, World->GetName());
+	}
+}
+
+void UActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const UGameInstance* GameInstance = InWorld.GetGameInstance();
+	if (!GameInstance)
+	{
+		return;
+	}
+
+	UActorPoolTravelSubsystem* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+	if (TravelSubsystem->IsInTransition)
+	{
+		// The pools are restored by the destination World
+		return;
+	}
+
+	TMap<TSubclassOf<AActor>, int32> MissingActors = MoveTemp(TravelSubsystem->PrewarmSnapshot);
+	TravelSubsystem->PrewarmSnapshot.Reset();
+
+	// Actors carried by seamless travel are already here, only the difference has to be spawned.
+	for (const TWeakObjectPtr<AActor>& TravelingActor : TravelSubsystem->TravelingActors)
+	{
+		AActor* Actor = TravelingActor.Get();
+		if (!Actor || Actor->GetWorld() != &InWorld)
+		{
+			continue;
+		}
+
+		Pools.FindOrAdd(Actor->GetClass()).FreeActors.Add(Actor);
+		if (int32* Missing = MissingActors.Find(Actor->GetClass()))
+		{
+			--*Missing;
+		}
+	}
+	TravelSubsystem->TravelingActors.Reset();
+
+	if (!IsPoolingEnabled())
+	{
+		return;
+	}
+
+	for (const auto& [ActorClass, Count] : MissingActors)
+	{
+		if (ActorClass && Count > 0)
+		{
+			PopulatePool(&InWorld, ActorClass, Count);
+		}
+	}
+
+	if (IsLoggingEnabled() && !MissingActors.IsEmpty())
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "Restored {Count} persistent pools in World {Name}.",
+		          MissingActors.Num(), InWorld.GetName());
+	}
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	const UWorld* World = GetWorld();
+	if (const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr)
+	{
+		if (UActorPoolTravelSubsystem* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>())
+		{
+			for (const auto& [ActorClass, Pool] : Pools)
+			{
+				if (TravelSubsystem->IsPersistentClass(ActorClass) && !Pool.FreeActors.IsEmpty())
+				{
+					TravelSubsystem->PrewarmSnapshot.FindOrAdd(ActorClass) = Pool.FreeActors.Num();
+				}
+			}
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+void UActorPoolSubsystem::AcquirePooledPawn(APawn* Pawn, IPoolablePawn* PoolablePawn, const FTransform& SpawnTransform)
+{
+	Pawn->SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// The Controller is retained across pooling cycles, it's spawned again only if something unpossessed the Pawn.
+	if (!Pawn->GetController() && Pawn->AutoPossessAI != EAutoPossessAI::Disabled)
+	{
+		Pawn->SpawnDefaultController();
+	}
+
+	PoolablePawn->ResetHealth();
+
+	if (AAIController* AIController = Cast<AAIController>(Pawn->GetController()))
+	{
+		PoolablePawn->ResetPerception(AIController->GetAIPerceptionComponent());
+		PoolablePawn->ResetBlackboard(AIController->GetBlackboardComponent());
+		AIController->SetActorTickEnabled(true);
+		if (UBrainComponent* Brain = AIController->GetBrainComponent())
+		{
+			Brain->ResumeLogic(TEXT("Acquired from pool"));
+			Brain->RestartLogic();
+		}
+	}
+
+	if (UPawnMovementComponent* Movement = Pawn->GetMovementComponent())
+	{
+		Movement->Activate(true);
+	}
+
+	if (const ACharacter* Character = Cast<ACharacter>(Pawn))
+	{
+		Character->GetMesh()->SetComponentTickEnabled(true);
+	}
+
+	Pawn->SetActorHiddenInGame(false);
+	Pawn->SetActorEnableCollision(true);
+	Pawn->SetActorTickEnabled(true);
+
+	if (IsLoggingEnabled())
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "Resumed Pawn {Name} controlled by {Controller}.", Pawn->GetName(),
+		          GetNameSafe(Pawn->GetController()));
+	}
+}
+
+void UActorPoolSubsystem::ReleasePooledPawn(APawn* Pawn)
+{
+	Pawn->SetActorTickEnabled(false);
+	Pawn->SetActorEnableCollision(false);
+	Pawn->SetActorHiddenInGame(true);
+
+	if (AAIController* AIController = Cast<AAIController>(Pawn->GetController()))
+	{
+		AIController->StopMovement();
+		if (UBrainComponent* Brain = AIController->GetBrainComponent())
+		{
+			Brain->PauseLogic(TEXT("Released to pool"));
+		}
+		AIController->SetActorTickEnabled(false);
+	}
+
+	if (UPawnMovementComponent* Movement = Pawn->GetMovementComponent())
+	{
+		Movement->StopMovementImmediately();
+		Movement->Deactivate();
+	}
+
+	// Animations aren't evaluated while pooled, but the Skeletal Mesh instance is kept.
+	if (const ACharacter* Character = Cast<ACharacter>(Pawn))
+	{
+		Character->GetMesh()->SetComponentTickEnabled(false);
+	}
+
+	if (IsLoggingEnabled())
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "Paused Pawn {Name} controlled by {Controller}.", Pawn->GetName(),
+		          GetNameSafe(Pawn->GetController()));
+	}
+}
+
+void UActorPoolSubsystem::LogAcquired(const AActor* Actor, bool IsReused)
+{
+	if (IsReused)
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "Reusing Actor {Name} of Class {Class}", Actor->GetName(),
+		          Actor->GetClass()->GetName());
+	}
+	else
+	{
+		UE_LOGFMT(LogObjectPoolingSystem, Display, "Spawning new Actor {Name} of Class {Class}.", GetNameSafe(Actor),
+		          GetNameSafe(Actor ? Actor->GetClass() : nullptr));
+	}
+}
+
+void UActorPoolSubsystem::LogReleased(const AActor* Actor)
+{
+	UE_LOGFMT(LogObjectPoolingSystem, Display, "Released Actor {Name} to the class pool.", Actor->GetName());
+}
@@ -0,0 +1,18 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "ActorPoolTravelSubsystem.h"
+
+bool UActorPoolTravelSubsystem::IsPersistentClass(TSubclassOf<AActor> ActorClass) const
+{
+	return PersistentClasses.Contains(ActorClass);
+}
+
+bool UActorPoolTravelSubsystem::IsTravelingThroughTransition() const
+{
+	return IsInTransition;
+}
+
+const TMap<TSubclassOf<AActor>, int32>& UActorPoolTravelSubsystem::GetPrewarmSnapshot() const
+{
+	return PrewarmSnapshot;
+}
@@ -0,0 +1,88 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "FrameArena.h"
+
+#include "ObjectPoolingSystemPlugin.h"
+
+FFrameArena::FFrameArena(SIZE_T InitialCapacity, SIZE_T InMaxCapacity)
+	: Buffer(static_cast<uint8*>(FMemory::Malloc(InitialCapacity))),
+	  Capacity(InitialCapacity),
+	  MinCapacity(InitialCapacity),
+	  MaxCapacity(FMath::Max(InitialCapacity, InMaxCapacity))
+{
+}
+
+FFrameArena::~FFrameArena()
+{
+	Reset();
+	FMemory::Free(Buffer);
+}
+
+FFrameArena& FFrameArena::Get(const UWorld* World)
+{
+	check(IsInGameThread());
+	return FObjectPoolingSystemPluginModule::GetFrameArena(World);
+}
+
+void* FFrameArena::Allocate(SIZE_T Size, SIZE_T Alignment)
+{
+	const SIZE_T AlignedOffset = Align(Offset, Alignment);
+	if (LIKELY(AlignedOffset + Size <= Capacity))
+	{
+		Offset = AlignedOffset + Size;
+		return Buffer + AlignedOffset;
+	}
+
+	OverflowSize += Size + Alignment;
+	return OverflowAllocations.Add_GetRef(FMemory::Malloc(Size, Alignment));
+}
+
+void FFrameArena::Reset()
+{
+	if (UNLIKELY(!OverflowAllocations.IsEmpty()))
+	{
+		for (void* Allocation : OverflowAllocations)
+		{
+			FMemory::Free(Allocation);
+		}
+		OverflowAllocations.Reset();
+
+		UnderusedResets = 0;
+		const SIZE_T NewCapacity = FMath::Min(Capacity + OverflowSize, MaxCapacity);
+		OverflowSize = 0;
+		if (NewCapacity != Capacity)
+		{
+			Resize(NewCapacity);
+		}
+	}
+	else if (Offset < Capacity / 4 && Capacity > MinCapacity)
+	{
+		if (++UnderusedResets >= ShrinkAfterResets)
+		{
+			UnderusedResets = 0;
+			Resize(FMath::Max(Capacity / 2, MinCapacity));
+		}
+	}
+	else
+	{
+		UnderusedResets = 0;
+	}
+	Offset = 0;
+}
+
+void FFrameArena::Resize(SIZE_T NewCapacity)
+{
+	FMemory::Free(Buffer);
+	Buffer = static_cast<uint8*>(FMemory::Malloc(NewCapacity));
+	Capacity = NewCapacity;
+}
+
+SIZE_T FFrameArena::GetUsedSize() const
+{
+	return Offset + OverflowSize;
+}
+
+SIZE_T FFrameArena::GetCapacity() const
+{
+	return Capacity;
+}
@@ -2,14 +2,76 @@
 
 #include "ObjectPoolingSystemPlugin.h"
 
+#include "FrameArena.h"
+
+#include "Engine/World.h"
+
+#include "Misc/CoreDelegates.h"
+
 #define LOCTEXT_NAMESPACE "FObjectPoolingSystemPluginModule"
 
+static FObjectPoolingSystemPluginModule* GObjectPoolingSystemPluginModule = nullptr;
+
 void FObjectPoolingSystemPluginModule::StartupModule()
 {
+	GObjectPoolingSystemPluginModule = this;
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddLambda([this]
+	{
+		for (const TPair<const UWorld*, TUniquePtr<FFrameArena>>& Arena : FrameArenas)
+		{
+			Arena.Value->Reset();
+		}
+	});
+	// Ticking a World by hand, like tests do, doesn't end the engine frame.
+	// Only the arena of the World that ticks is reset: the others may still hold the data of their own tick.
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddLambda([this](UWorld* World, ELevelTick, float)
+	{
+		if (const TUniquePtr<FFrameArena>* Arena = FrameArenas.Find(World))
+		{
+			(*Arena)->Reset();
+		}
+	});
+	PostWorldCleanupHandle = FWorldDelegates::OnPostWorldCleanup.AddLambda([this](UWorld* World, bool, bool)
+	{
+		if (LastWorld == World)
+		{
+			LastWorld = nullptr;
+			LastFrameArena = nullptr;
+		}
+		FrameArenas.Remove(World);
+	});
 }
 
 void FObjectPoolingSystemPluginModule::ShutdownModule()
 {
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	FWorldDelegates::OnPostWorldCleanup.Remove(PostWorldCleanupHandle);
+	LastWorld = nullptr;
+	LastFrameArena = nullptr;
+	FrameArenas.Empty();
+	GObjectPoolingSystemPluginModule = nullptr;
+}
+
+FFrameArena& FObjectPoolingSystemPluginModule::GetFrameArena(const UWorld* World)
+{
+	checkf(GObjectPoolingSystemPluginModule, TEXT("ObjectPoolingSystemPlugin module isn't loaded."));
+	checkf(World, TEXT("Frame arenas belong to a World."));
+
+	FObjectPoolingSystemPluginModule& Module = *GObjectPoolingSystemPluginModule;
+	if (LIKELY(Module.LastWorld == World))
+	{
+		return *Module.LastFrameArena;
+	}
+
+	TUniquePtr<FFrameArena>& Arena = Module.FrameArenas.FindOrAdd(World);
+	if (!Arena)
+	{
+		Arena = MakeUnique<FFrameArena>();
+	}
+	Module.LastWorld = World;
+	Module.LastFrameArena = Arena.Get();
+	return *Arena;
 }
 
 #undef LOCTEXT_NAMESPACE
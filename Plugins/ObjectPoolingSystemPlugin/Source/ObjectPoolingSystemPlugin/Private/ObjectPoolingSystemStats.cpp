@@ -0,0 +1,5 @@
+﻿#include "ObjectPoolingSystemStats.h"
+
+DEFINE_STAT(STAT_ObjectPoolingSystem_Acquired);
+DEFINE_STAT(STAT_ObjectPoolingSystem_Spawned);
+DEFINE_STAT(STAT_ObjectPoolingSystem_Released);
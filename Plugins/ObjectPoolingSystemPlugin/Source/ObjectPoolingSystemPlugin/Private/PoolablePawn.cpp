@@ -0,0 +1,31 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "PoolablePawn.h"
+
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "Perception/AIPerceptionComponent.h"
+
+void IPoolablePawn::ResetPerception(UAIPerceptionComponent* PerceptionComponent)
+{
+	if (PerceptionComponent)
+	{
+		PerceptionComponent->ForgetAll();
+	}
+}
+
+void IPoolablePawn::ResetBlackboard(UBlackboardComponent* BlackboardComponent)
+{
+	if (!BlackboardComponent)
+	{
+		return;
+	}
+
+	for (const UBlackboardData* Data = BlackboardComponent->GetBlackboardAsset(); Data; Data = Data->Parent)
+	{
+		for (const FBlackboardEntry& Entry : Data->Keys)
+		{
+			BlackboardComponent->ClearValue(Entry.EntryName);
+		}
+	}
+}
@@ -8,6 +8,8 @@
 #include "Subsystems/WorldSubsystem.h"
 #include "ActorPoolSubsystem.generated.h"
 
+class IPoolablePawn;
+
 USTRUCT()
 struct FActorPool
 {
@@ -22,6 +24,9 @@ class OBJECTPOOLINGSYSTEMPLUGIN_API UActorPoolSubsystem : public UWorldSubsystem
 {
 	GENERATED_BODY()
 
+	template <typename, typename>
+	friend class TActorPool;
+
 	UPROPERTY()
 	TMap<TSubclassOf<AActor>, FActorPool> Pools;
 
@@ -52,4 +57,26 @@ public:
 	static FPoolStats GetPoolStats(UWorld* World, TSubclassOf<AActor> ActorClass);
 
 	static void LogStats(UWorld* World);
+
+	// Opt-in: the pool of ActorClass survives map changes.
+	// Its size is snapshotted when this World is torn down and prewarmed again in the next one.
+	// Actors listed via AddSeamlessTravelActors are moved to the next World instead of being respawned.
+	// ActorClass must be travel-safe: it can't reference anything owned by the Level it has been spawned in.
+	static void SetPersistentAcrossTravel(UWorld* World, TSubclassOf<AActor> ActorClass, bool IsPersistent = true);
+
+	// Call it from AGameModeBase::GetSeamlessTravelActorList, forwarding bToTransition, to carry the free Actors
+	// of persistent pools to the destination World.
+	// With a transition map the Actors leaving the source World are carried through it untouched.
+	static void AddSeamlessTravelActors(UWorld* World, bool IsToTransition, TArray<AActor*>& ActorList);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+private:
+	// Pawns implementing IPoolablePawn keep Controller, AI logic and meshes, they are only paused and resumed.
+	static void AcquirePooledPawn(APawn* Pawn, IPoolablePawn* PoolablePawn, const FTransform& SpawnTransform);
+	static void ReleasePooledPawn(APawn* Pawn);
+
+	static void LogAcquired(const AActor* Actor, bool IsReused);
+	static void LogReleased(const AActor* Actor);
 };
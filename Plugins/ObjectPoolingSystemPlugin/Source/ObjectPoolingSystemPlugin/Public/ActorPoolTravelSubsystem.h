@@ -0,0 +1,42 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ActorPoolTravelSubsystem.generated.h"
+
+/**
+ * Keeps the pooling state that must outlive a single World:
+ * - which Actor classes are travel-safe and should keep their pool across map changes
+ * - the prewarm snapshot (pool size per class) taken when the previous World was torn down
+ * - the pooled Actors that are being carried to the next World by seamless travel,
+ *   through the transition map too, if there's one
+ */
+UCLASS()
+class OBJECTPOOLINGSYSTEMPLUGIN_API UActorPoolTravelSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+	friend class UActorPoolSubsystem;
+
+	UPROPERTY()
+	TSet<TSubclassOf<AActor>> PersistentClasses;
+
+	UPROPERTY()
+	TMap<TSubclassOf<AActor>, int32> PrewarmSnapshot;
+
+	TArray<TWeakObjectPtr<AActor>> TravelingActors;
+
+	// Between leaving the source World and leaving the transition map,
+	// the transition World neither adopts the traveling Actors nor consumes the snapshot
+	bool IsInTransition = false;
+
+public:
+	bool IsPersistentClass(TSubclassOf<AActor> ActorClass) const;
+
+	bool IsTravelingThroughTransition() const;
+
+	const TMap<TSubclassOf<AActor>, int32>& GetPrewarmSnapshot() const;
+};
@@ -0,0 +1,71 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ * Linear allocator for transient data that lives at most until the end of the frame.
+ * Allocating is a pointer bump, everything is discarded at once by Reset().
+ * Destructors are never called, so it can only hold types that don't own resources.
+ * When the capacity is exceeded it falls back to the heap, then grows during the next Reset() to fit the peak usage,
+ * up to MaxCapacity. After ShrinkAfterResets resets using less than a quarter of it, the capacity is halved,
+ * down to the initial one.
+ * Not thread-safe.
+ */
+class OBJECTPOOLINGSYSTEMPLUGIN_API FFrameArena
+{
+	uint8* Buffer = nullptr;
+	SIZE_T Capacity = 0;
+	SIZE_T Offset = 0;
+	SIZE_T MinCapacity = 0;
+	SIZE_T MaxCapacity = 0;
+	int32 UnderusedResets = 0;
+
+	TArray<void*> OverflowAllocations;
+	SIZE_T OverflowSize = 0;
+
+	void Resize(SIZE_T NewCapacity);
+
+public:
+	static constexpr SIZE_T DefaultCapacity = 64 * 1024;
+	static constexpr SIZE_T DefaultMaxCapacity = 4 * 1024 * 1024;
+	static constexpr int32 ShrinkAfterResets = 600;
+
+	explicit FFrameArena(SIZE_T InitialCapacity = DefaultCapacity, SIZE_T InMaxCapacity = DefaultMaxCapacity);
+	~FFrameArena();
+
+	FFrameArena(const FFrameArena&) = delete;
+	FFrameArena& operator=(const FFrameArena&) = delete;
+
+	// Arena of the World, for the game thread. Reset when that World starts ticking and at the end of every frame.
+	static FFrameArena& Get(const UWorld* World);
+
+	void* Allocate(SIZE_T Size, SIZE_T Alignment);
+
+	template <typename T, typename... ArgTypes>
+	T* New(ArgTypes&&... Args)
+	{
+		return new(Allocate(sizeof(T), alignof(T))) T(Forward<ArgTypes>(Args)...);
+	}
+
+	// Default constructs Num elements.
+	template <typename T>
+	TArrayView<T> NewArray(int32 Num)
+	{
+		check(Num >= 0);
+		T* Elements = static_cast<T*>(Allocate(sizeof(T) * Num, alignof(T)));
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			new(Elements + Index) T();
+		}
+		return TArrayView<T>(Elements, Num);
+	}
+
+	void Reset();
+
+	SIZE_T GetUsedSize() const;
+	SIZE_T GetCapacity() const;
+};
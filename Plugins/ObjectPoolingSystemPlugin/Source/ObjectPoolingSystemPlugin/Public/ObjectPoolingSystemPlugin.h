@@ -5,10 +5,26 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+class FFrameArena;
+class UWorld;
+
 class FObjectPoolingSystemPluginModule : public IModuleInterface
 {
 public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	// Created the first time the World asks for it, destroyed with the World.
+	static FFrameArena& GetFrameArena(const UWorld* World);
+
+private:
+	TMap<const UWorld*, TUniquePtr<FFrameArena>> FrameArenas;
+	// Shots ask for the arena of the same World over and over
+	const UWorld* LastWorld = nullptr;
+	FFrameArena* LastFrameArena = nullptr;
+
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle PostWorldCleanupHandle;
 };
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Object Pooling System"), STATGROUP_ObjectPoolingSystem, STATCAT_ObjectPoolingSystem);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Acquired"), STAT_ObjectPoolingSystem_Acquired, STATGROUP_ObjectPoolingSystem,
+                                  OBJECTPOOLINGSYSTEMPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Spawned"), STAT_ObjectPoolingSystem_Spawned, STATGROUP_ObjectPoolingSystem,
+                                  OBJECTPOOLINGSYSTEMPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Released"), STAT_ObjectPoolingSystem_Released, STATGROUP_ObjectPoolingSystem,
+                                  OBJECTPOOLINGSYSTEMPLUGIN_API);
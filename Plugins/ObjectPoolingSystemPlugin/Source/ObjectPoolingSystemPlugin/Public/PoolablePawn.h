@@ -0,0 +1,38 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PoolablePawn.generated.h"
+
+class UAIPerceptionComponent;
+class UBlackboardComponent;
+
+UINTERFACE(MinimalAPI)
+class UPoolablePawn : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Any poolable APawn or ACharacter shall inherit this interface to keep its Controller,
+ * Behavior Tree and Skeletal Mesh alive while it sits in the pool.
+ * Releasing it pauses movement, AI logic and animations, acquiring it teleports and resumes them.
+ * The hooks are called while the Pawn is being acquired, before its logic is restarted.
+ */
+class OBJECTPOOLINGSYSTEMPLUGIN_API IPoolablePawn
+{
+	GENERATED_BODY()
+
+public:
+	virtual void ResetHealth()
+	{
+	}
+
+	// By default forgets every perceived stimulus.
+	virtual void ResetPerception(UAIPerceptionComponent* PerceptionComponent);
+
+	// By default clears every key, including the ones inherited from the parent Blackboards.
+	virtual void ResetBlackboard(UBlackboardComponent* BlackboardComponent);
+};
@@ -0,0 +1,187 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ActorPoolSubsystem.h"
+#include "ObjectPoolingSystemStats.h"
+#include "PoolableActor.h"
+#include "PoolablePawn.h"
+
+#include "Engine/World.h"
+
+// Every feature is available, the CVars are read at runtime.
+struct FActorPoolDefaultPolicy
+{
+	// If false, ObjectPoolingSystem.ActorPooling is ignored and Actors are always pooled.
+	static constexpr bool HonorPoolingCVar = true;
+	// If false, ObjectPoolingSystem.EnableActorLogging is ignored and nothing is logged.
+	static constexpr bool EnableLogging = true;
+	static constexpr bool EnableStats = true;
+	static constexpr bool EnableValidation = true;
+};
+
+// Only pooling, no branches on CVars, no logging, no stats, no validation.
+struct FActorPoolShippingPolicy
+{
+	static constexpr bool HonorPoolingCVar = false;
+	static constexpr bool EnableLogging = false;
+	static constexpr bool EnableStats = false;
+	static constexpr bool EnableValidation = false;
+};
+
+#if UE_BUILD_SHIPPING
+using FActorPoolBuildPolicy = FActorPoolShippingPolicy;
+#else
+using FActorPoolBuildPolicy = FActorPoolDefaultPolicy;
+#endif
+
+/**
+ * Typed view over the pool of a single class, shares the storage with UActorPoolSubsystem.
+ * What the untyped API decides at runtime is decided at compile time by TPolicy,
+ * IPoolableActor and IPoolablePawn notifications are resolved from T, so there's no Cast in the hot path.
+ * For this reason, subclasses of T can't implement those interfaces on their own.
+ * It's cheap to construct, it can be built on the fly or kept around as long as the World is alive.
+ */
+template <typename T, typename TPolicy = FActorPoolBuildPolicy>
+class TActorPool
+{
+	static_assert(std::is_base_of_v<AActor, T>, "TActorPool can only pool Actors.");
+	static_assert(!std::is_base_of_v<IPoolablePawn, T> || std::is_base_of_v<APawn, T>,
+		"IPoolablePawn can only be implemented by Pawns.");
+
+	UWorld* World;
+	UActorPoolSubsystem* Subsystem;
+	TSubclassOf<T> ActorClass;
+
+public:
+	explicit TActorPool(UWorld* InWorld, TSubclassOf<T> InActorClass = T::StaticClass())
+		: World(InWorld), Subsystem(InWorld->GetSubsystem<UActorPoolSubsystem>()), ActorClass(InActorClass)
+	{
+		check(World);
+		check(Subsystem);
+		check(ActorClass);
+	}
+
+	// See UActorPoolSubsystem::SpawnOrAcquireFromPool
+	T* Acquire(const FTransform& SpawnTransform = FTransform::Identity, const FActorSpawnParameters& SpawnParams = {})
+	{
+		if constexpr (TPolicy::HonorPoolingCVar)
+		{
+			if (UNLIKELY(!UActorPoolSubsystem::IsPoolingEnabled()))
+			{
+				return Spawn(SpawnTransform, SpawnParams);
+			}
+		}
+
+		FActorPool* Pool = Subsystem->Pools.Find(ActorClass);
+		if (!Pool || Pool->FreeActors.IsEmpty())
+		{
+			return Spawn(SpawnTransform, SpawnParams);
+		}
+
+		T* Actor = static_cast<T*>(Pool->FreeActors.Pop(false));
+		if constexpr (TPolicy::EnableValidation)
+		{
+			checkf(IsValid(Actor), TEXT("Pooled Actor of Class %s has been destroyed while in the pool."),
+			       *ActorClass->GetName());
+		}
+		if constexpr (TPolicy::EnableStats)
+		{
+			INC_DWORD_STAT(STAT_ObjectPoolingSystem_Acquired);
+		}
+		if constexpr (TPolicy::EnableLogging)
+		{
+			if (UActorPoolSubsystem::IsLoggingEnabled())
+			{
+				UActorPoolSubsystem::LogAcquired(Actor, true);
+			}
+		}
+
+		if constexpr (std::is_base_of_v<IPoolablePawn, T>)
+		{
+			UActorPoolSubsystem::AcquirePooledPawn(Actor, Actor, SpawnTransform);
+		}
+		if constexpr (std::is_base_of_v<IPoolableActor, T>)
+		{
+			Actor->AcquiredFromPool(SpawnTransform, SpawnParams.Owner);
+		}
+		return Actor;
+	}
+
+	// See UActorPoolSubsystem::DestroyOrReleaseToPool
+	void Release(T* Actor)
+	{
+		if constexpr (TPolicy::EnableValidation)
+		{
+			checkf(Actor, TEXT("Tried to insert nullptr to the pool."));
+			checkf(Actor->GetClass() == ActorClass.Get(), TEXT("Tried to insert an Actor of Class %s to the pool of %s."),
+			       *Actor->GetClass()->GetName(), *ActorClass->GetName());
+		}
+		if constexpr (TPolicy::HonorPoolingCVar)
+		{
+			if (UNLIKELY(!UActorPoolSubsystem::IsPoolingEnabled()))
+			{
+				UActorPoolSubsystem::DestroyOrReleaseToPool(World, Actor);
+				return;
+			}
+		}
+
+		if constexpr (std::is_base_of_v<IPoolableActor, T>)
+		{
+			Actor->ReleasedToPool();
+		}
+		if constexpr (std::is_base_of_v<IPoolablePawn, T>)
+		{
+			UActorPoolSubsystem::ReleasePooledPawn(Actor);
+		}
+
+		TArray<AActor*>& FreeActors = Subsystem->Pools.FindOrAdd(ActorClass).FreeActors;
+		if constexpr (TPolicy::EnableValidation)
+		{
+			checkf(!FreeActors.Contains(Actor), TEXT("Actor already released to the pool!"));
+		}
+		FreeActors.Add(Actor);
+
+		if constexpr (TPolicy::EnableStats)
+		{
+			INC_DWORD_STAT(STAT_ObjectPoolingSystem_Released);
+		}
+		if constexpr (TPolicy::EnableLogging)
+		{
+			if (UActorPoolSubsystem::IsLoggingEnabled())
+			{
+				UActorPoolSubsystem::LogReleased(Actor);
+			}
+		}
+	}
+
+	void Populate(int32 Count)
+	{
+		UActorPoolSubsystem::PopulatePool(World, ActorClass, Count);
+	}
+
+	int32 Num() const
+	{
+		const FActorPool* Pool = Subsystem->Pools.Find(ActorClass);
+		return Pool ? Pool->FreeActors.Num() : 0;
+	}
+
+private:
+	T* Spawn(const FTransform& SpawnTransform, const FActorSpawnParameters& SpawnParams)
+	{
+		T* Actor = World->SpawnActor<T>(ActorClass, SpawnTransform, SpawnParams);
+		if constexpr (TPolicy::EnableStats)
+		{
+			INC_DWORD_STAT(STAT_ObjectPoolingSystem_Spawned);
+		}
+		if constexpr (TPolicy::EnableLogging)
+		{
+			if (UActorPoolSubsystem::IsLoggingEnabled())
+			{
+				UActorPoolSubsystem::LogAcquired(Actor, false);
+			}
+		}
+		return Actor;
+	}
+};
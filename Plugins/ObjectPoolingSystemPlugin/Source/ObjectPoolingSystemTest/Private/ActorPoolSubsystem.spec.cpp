@@ -1,4 +1,6 @@
 ﻿#include "ActorPoolSubsystem.h"
+#include "ActorPoolTravelSubsystem.h"
+#include "TypedActorPool.h"
 
 #include "Logging/StructuredLog.h"
 
@@ -6,6 +8,7 @@
 #include "TestWorldActor.h"
 #include "PoolTestActor_Alice.h"
 #include "PoolTestActor_Bob.h"
+#include "PoolTestPawn_Carol.h"
 
 #include "TestWorldSubsystem.h"
 
@@ -357,6 +360,185 @@ void FActorPoolSubsystem_Spec::Define()
 			});
 		});
 
+		Describe("When pooling Pawns", [this]
+		{
+			It("Should keep the same Controller across pooling cycles", [this]
+			{
+				UClass* PawnClass = APoolTestPawn_Carol::StaticClass();
+				auto* Pawn = Cast<APoolTestPawn_Carol>(
+					UActorPoolSubsystem::SpawnOrAcquireFromPool(WorldContextObject, PawnClass));
+				TestTrueExpr(Pawn != nullptr);
+				const AController* Controller = Pawn->GetController();
+				TestTrueExpr(Controller != nullptr);
+
+				for (int32 Iterations = GetRandomValue(); Iterations > 0; --Iterations)
+				{
+					UActorPoolSubsystem::DestroyOrReleaseToPool(WorldContextObject, Pawn);
+					TestTrueExpr(Pawn->GetController() == Controller);
+					TestTrueExpr(Pawn->IsHidden() && !Pawn->GetActorEnableCollision());
+					TestTrueExpr(Pawn == UActorPoolSubsystem::SpawnOrAcquireFromPool(WorldContextObject, PawnClass));
+				}
+				TestTrueExpr(Pawn->GetController() == Controller);
+				TestTrueExpr(!Pawn->IsHidden() && Pawn->GetActorEnableCollision());
+			});
+
+			It("Should reset the Pawn each time it's acquired", [this]
+			{
+				UClass* PawnClass = APoolTestPawn_Carol::StaticClass();
+				const int32 Iterations = GetRandomValue();
+				auto* Pawn = Cast<APoolTestPawn_Carol>(
+					UActorPoolSubsystem::SpawnOrAcquireFromPool(WorldContextObject, PawnClass));
+				for (int32 Count = 0; Count < Iterations; ++Count)
+				{
+					UActorPoolSubsystem::DestroyOrReleaseToPool(WorldContextObject, Pawn);
+					UActorPoolSubsystem::SpawnOrAcquireFromPool(WorldContextObject, PawnClass);
+				}
+				TestTrueExpr(Pawn->ResetHealthCounter == Iterations);
+			});
+
+			It("Should teleport the Pawn where it's acquired", [this]
+			{
+				UClass* PawnClass = APoolTestPawn_Carol::StaticClass();
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, PawnClass, 1);
+				const FTransform SpawnTransform{FVector{100, 200, 300}};
+				const AActor* Pawn = UActorPoolSubsystem::SpawnOrAcquireFromPool(
+					WorldContextObject, PawnClass, SpawnTransform);
+				TestTrueExpr(Pawn->GetActorLocation().Equals(SpawnTransform.GetLocation()));
+			});
+		});
+
+		Describe("When using a typed pool", [this]
+		{
+			It("Should share the pool with the untyped API", [this]
+			{
+				const int32 PoolSize = GetRandomValue();
+				TActorPool<APoolTestActor_Alice> Pool{WorldContextObject};
+				Pool.Populate(PoolSize);
+				auto Stats = UActorPoolSubsystem::GetPoolStats(WorldContextObject, APoolTestActor_Alice::StaticClass());
+				TestTrueExpr(Pool.Num() == PoolSize);
+				TestTrueExpr(Stats.NumberOfPooledObjects == PoolSize);
+
+				APoolTestActor_Alice* Actor = Pool.Acquire();
+				TestTrueExpr(Actor != nullptr);
+				TestTrueExpr(Pool.Num() == PoolSize - 1);
+				UActorPoolSubsystem::DestroyOrReleaseToPool(WorldContextObject, Actor);
+				TestTrueExpr(Pool.Num() == PoolSize);
+			});
+
+			It("Should return the same Actor, if acquired and released continuously", [this]
+			{
+				TActorPool<APoolTestActor_Bob, FActorPoolShippingPolicy> Pool{WorldContextObject};
+				TArray<AActor*> SpawnedActors;
+				SpawnedActors.Add(Pool.Acquire());
+				for (int32 Iterations = GetRandomValue(); Iterations > 0; --Iterations)
+				{
+					Pool.Release(CastChecked<APoolTestActor_Bob>(SpawnedActors.Last()));
+					SpawnedActors.Add(Pool.Acquire());
+				}
+
+				TestTrueExpr(AreActorsValid(SpawnedActors));
+				TestTrueExpr(AreTheSameActor(SpawnedActors[0], SpawnedActors));
+				TestTrueExpr(Pool.Num() == 0);
+			});
+
+			It("Should notify poolable Pawns without casting", [this]
+			{
+				TActorPool<APoolTestPawn_Carol> Pool{WorldContextObject};
+				APoolTestPawn_Carol* Pawn = Pool.Acquire();
+				const int32 Iterations = GetRandomValue();
+				for (int32 Count = 0; Count < Iterations; ++Count)
+				{
+					Pool.Release(Pawn);
+					TestTrueExpr(Pawn == Pool.Acquire());
+				}
+				TestTrueExpr(Pawn->ResetHealthCounter == Iterations);
+			});
+		});
+
+		Describe("When persisting pools across travel", [this]
+		{
+			It("Should snapshot only the persistent pools when the World is torn down", [this]
+			{
+				UGameInstance* GameInstance = WorldContextObject->GetGameInstance();
+				const auto* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+				UActorPoolSubsystem::SetPersistentAcrossTravel(WorldContextObject, APoolTestActor_Alice::StaticClass());
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, APoolTestActor_Alice::StaticClass(), 5);
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, APoolTestActor_Bob::StaticClass(), 3);
+
+				{
+					FTestWorldHelper TornDownWorld = MoveTemp(World);
+				}
+
+				const auto& Snapshot = TravelSubsystem->GetPrewarmSnapshot();
+				TestTrueExpr(Snapshot.Num() == 1);
+				TestTrueExpr(Snapshot.FindRef(APoolTestActor_Alice::StaticClass()) == 5);
+			});
+
+			It("Should prewarm the persistent pools in the next World", [this]
+			{
+				UGameInstance* GameInstance = WorldContextObject->GetGameInstance();
+				const auto* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+				UActorPoolSubsystem::SetPersistentAcrossTravel(WorldContextObject, APoolTestActor_Alice::StaticClass());
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, APoolTestActor_Alice::StaticClass(), 5);
+
+				{
+					FTestWorldHelper TornDownWorld = MoveTemp(World);
+				}
+
+				FTestWorldHelper NextWorld = TestSubsystem->GetPrivateWorld("FActorPoolSubsystem_Spec_NextWorld");
+				NextWorld->SetGameInstance(GameInstance);
+				NextWorld->GetSubsystem<UActorPoolSubsystem>()->OnWorldBeginPlay(*NextWorld->GetWorld());
+
+				const auto Stats = UActorPoolSubsystem::GetPoolStats(NextWorld->GetWorld(),
+				                                                     APoolTestActor_Alice::StaticClass());
+				TestTrueExpr(Stats.NumberOfPooledObjects == 5);
+				TestTrueExpr(TravelSubsystem->GetPrewarmSnapshot().IsEmpty());
+			});
+
+			It("Should carry the free Actors of persistent pools through the transition map", [this]
+			{
+				UGameInstance* GameInstance = WorldContextObject->GetGameInstance();
+				const auto* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+				UActorPoolSubsystem::SetPersistentAcrossTravel(WorldContextObject, APoolTestActor_Alice::StaticClass());
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, APoolTestActor_Alice::StaticClass(), 4);
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, APoolTestActor_Bob::StaticClass(), 2);
+
+				TArray<AActor*> ToTransition;
+				UActorPoolSubsystem::AddSeamlessTravelActors(WorldContextObject, true, ToTransition);
+				TestTrueExpr(ToTransition.Num() == 4);
+				TestTrueExpr(Algo::AllOf(ToTransition, [](const AActor* Actor) { return Actor->IsA<APoolTestActor_Alice>(); }));
+				TestTrueExpr(TravelSubsystem->IsTravelingThroughTransition());
+
+				// The transition World doesn't adopt what's traveling through it
+				FTestWorldHelper TransitionWorld = TestSubsystem->GetPrivateWorld("FActorPoolSubsystem_Spec_TransitionWorld");
+				TransitionWorld->SetGameInstance(GameInstance);
+				TransitionWorld->GetSubsystem<UActorPoolSubsystem>()->OnWorldBeginPlay(*TransitionWorld->GetWorld());
+				TestTrueExpr(UActorPoolSubsystem::GetAllPoolStats(TransitionWorld->GetWorld()).IsEmpty());
+
+				TArray<AActor*> ToDestination;
+				UActorPoolSubsystem::AddSeamlessTravelActors(TransitionWorld->GetWorld(), false, ToDestination);
+				TestTrueExpr(ToDestination == ToTransition);
+				TestFalseExpr(TravelSubsystem->IsTravelingThroughTransition());
+			});
+
+			It("Should forget the snapshot of a pool that isnt persistent anymore", [this]
+			{
+				UGameInstance* GameInstance = WorldContextObject->GetGameInstance();
+				const auto* TravelSubsystem = GameInstance->GetSubsystem<UActorPoolTravelSubsystem>();
+				UActorPoolSubsystem::SetPersistentAcrossTravel(WorldContextObject, APoolTestActor_Alice::StaticClass());
+				UActorPoolSubsystem::PopulatePool(WorldContextObject, APoolTestActor_Alice::StaticClass(), 5);
+				UActorPoolSubsystem::SetPersistentAcrossTravel(WorldContextObject, APoolTestActor_Alice::StaticClass(),
+				                                              false);
+
+				{
+					FTestWorldHelper TornDownWorld = MoveTemp(World);
+				}
+
+				TestTrueExpr(TravelSubsystem->GetPrewarmSnapshot().IsEmpty());
+				TestFalseExpr(TravelSubsystem->IsPersistentClass(APoolTestActor_Alice::StaticClass()));
+			});
+		});
+
 		AfterEach([this]
 		{
 			World.~FTestWorldHelper();
@@ -0,0 +1,150 @@
+﻿#include "FrameArena.h"
+
+#include "ScopedAllocationCounter.h"
+#include "TestWorldSubsystem.h"
+
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FFrameArena_Spec, "ObjectPoolingSystem.Runtime.FrameArena",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	struct FShotRecord
+	{
+		FVector Start;
+		FVector Direction;
+		double Timestamp;
+		int32 Index;
+
+		FShotRecord() : Start(FVector::ZeroVector), Direction(FVector::ForwardVector), Timestamp(0.0), Index(INDEX_NONE)
+		{
+		}
+
+		explicit FShotRecord(int32 InIndex) : FShotRecord()
+		{
+			Index = InIndex;
+		}
+	};
+
+END_DEFINE_SPEC(FFrameArena_Spec)
+
+void FFrameArena_Spec::Define()
+{
+	Describe("FFrameArena", [this]
+	{
+		It("Should respect the alignment", [this]
+		{
+			FFrameArena Arena(1024);
+			Arena.Allocate(1, 1);
+			void* Aligned = Arena.Allocate(16, 16);
+			TestTrueExpr(IsAligned(Aligned, 16));
+		});
+
+		It("Should reuse the buffer after a Reset", [this]
+		{
+			FFrameArena Arena(1024);
+			FShotRecord* First = Arena.New<FShotRecord>(1);
+			TestTrueExpr(First->Index == 1);
+			Arena.Reset();
+			TestTrueExpr(Arena.GetUsedSize() == 0);
+
+			FShotRecord* Second = Arena.New<FShotRecord>(2);
+			TestTrueExpr(Second == First);
+		});
+
+		It("Should fall back to the heap and then grow when the capacity is exceeded", [this]
+		{
+			FFrameArena Arena(sizeof(FShotRecord) * 4);
+			TArrayView<FShotRecord> Records = Arena.NewArray<FShotRecord>(8);
+			TestTrueExpr(Records.Num() == 8);
+			TestTrueExpr(Records[7].Index == INDEX_NONE);
+			TestTrueExpr(Arena.GetUsedSize() > Arena.GetCapacity());
+
+			Arena.Reset();
+			TestTrueExpr(Arena.GetCapacity() >= sizeof(FShotRecord) * 12);
+
+			int64 Allocations;
+			{
+				FScopedAllocationCounter Counter;
+				Arena.NewArray<FShotRecord>(8);
+				Allocations = Counter.GetAllocations();
+			}
+			TestTrueExpr(Allocations == 0);
+		});
+
+		It("Shouldn't grow past its maximum capacity", [this]
+		{
+			FFrameArena Arena(64, 256);
+			Arena.Allocate(1024, 16);
+			Arena.Reset();
+			TestTrueExpr(Arena.GetCapacity() == 256);
+		});
+
+		It("Should shrink back after being underused for a while", [this]
+		{
+			FFrameArena Arena(64, 4096);
+			Arena.Allocate(1024, 16);
+			Arena.Reset();
+			const SIZE_T GrownCapacity = Arena.GetCapacity();
+			TestTrueExpr(GrownCapacity > 1024);
+
+			for (int32 Frame = 0; Frame < FFrameArena::ShrinkAfterResets; ++Frame)
+			{
+				Arena.Allocate(16, 16);
+				Arena.Reset();
+			}
+			TestTrueExpr(Arena.GetCapacity() < GrownCapacity);
+			TestTrueExpr(Arena.GetCapacity() >= 64);
+		});
+
+		It("Should reset the arena of a World when it ticks", [this]
+		{
+			FTestWorldHelper World = GEngine->GetEngineSubsystem<UTestWorldSubsystem>()->GetPrivateWorld(
+				"FFrameArena_Spec_World");
+			FFrameArena& Arena = FFrameArena::Get(World->GetWorld());
+			Arena.Allocate(16, 16);
+			TestTrueExpr(Arena.GetUsedSize() > 0);
+			World.Tick();
+			TestTrueExpr(Arena.GetUsedSize() == 0);
+		});
+
+		It("Shouldn't reset the arena of a World when another one ticks", [this]
+		{
+			UTestWorldSubsystem* TestSubsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			FTestWorldHelper World = TestSubsystem->GetPrivateWorld("FFrameArena_Spec_World");
+			FTestWorldHelper OtherWorld = TestSubsystem->GetPrivateWorld("FFrameArena_Spec_OtherWorld");
+			FFrameArena& Arena = FFrameArena::Get(World->GetWorld());
+			FFrameArena& OtherArena = FFrameArena::Get(OtherWorld->GetWorld());
+			TestTrueExpr(&Arena != &OtherArena);
+
+			Arena.Allocate(16, 16);
+			OtherArena.Allocate(16, 16);
+			OtherWorld.Tick();
+			TestTrueExpr(Arena.GetUsedSize() > 0);
+			TestTrueExpr(OtherArena.GetUsedSize() == 0);
+
+			World.Tick();
+			TestTrueExpr(Arena.GetUsedSize() == 0);
+		});
+
+		It("Shouldn't allocate memory while within capacity", [this]
+		{
+			FFrameArena Arena;
+			int64 Allocations;
+			{
+				FScopedAllocationCounter Counter;
+				for (int32 Frame = 0; Frame < 10; ++Frame)
+				{
+					for (int32 i = 0; i < 100; ++i)
+					{
+						Arena.New<FShotRecord>(i);
+					}
+					Arena.Reset();
+				}
+				Allocations = Counter.GetAllocations();
+			}
+			TestTrueExpr(Allocations == 0);
+		});
+	});
+}
@@ -0,0 +1,13 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "PoolTestPawn_Carol.h"
+
+APoolTestPawn_Carol::APoolTestPawn_Carol()
+{
+	AutoPossessAI = EAutoPossessAI::Spawned;
+}
+
+void APoolTestPawn_Carol::ResetHealth()
+{
+	++ResetHealthCounter;
+}
@@ -0,0 +1,21 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PoolablePawn.h"
+#include "GameFramework/Pawn.h"
+#include "PoolTestPawn_Carol.generated.h"
+
+UCLASS()
+class APoolTestPawn_Carol : public APawn, public IPoolablePawn
+{
+	GENERATED_BODY()
+
+public:
+	APoolTestPawn_Carol();
+
+	int ResetHealthCounter = 0;
+
+	virtual void ResetHealth() override;
+};
@@ -0,0 +1,126 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "ScopedAllocationCounter.h"
+
+#include "HAL/MemoryBase.h"
+
+namespace
+{
+class FCountingMalloc final : public FMalloc
+{
+public:
+	FMalloc* InnerMalloc = nullptr;
+	int64 Allocations = 0;
+	int64 Frees = 0;
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->Malloc(Count, Alignment);
+	}
+
+	virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->TryMalloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->TryRealloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override
+	{
+		if (Original && IsInGameThread())
+		{
+			++Frees;
+		}
+		InnerMalloc->Free(Original);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+	{
+		return InnerMalloc->QuantizeSize(Count, Alignment);
+	}
+
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+	{
+		return InnerMalloc->GetAllocationSize(Original, SizeOut);
+	}
+
+	virtual void Trim(bool bTrimThreadCaches) override
+	{
+		InnerMalloc->Trim(bTrimThreadCaches);
+	}
+
+	virtual void SetupTLSCachesOnCurrentThread() override
+	{
+		InnerMalloc->SetupTLSCachesOnCurrentThread();
+	}
+
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+	{
+		InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return InnerMalloc->IsInternallyThreadSafe();
+	}
+
+	virtual bool ValidateHeap() override
+	{
+		return InnerMalloc->ValidateHeap();
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return TEXT("FCountingMalloc");
+	}
+
+private:
+	void CountAllocation()
+	{
+		if (IsInGameThread())
+		{
+			++Allocations;
+		}
+	}
+};
+
+// Never destroyed: other threads could still be inside the proxy when a scope ends.
+FCountingMalloc GCountingMalloc;
+}
+
+FScopedAllocationCounter::FScopedAllocationCounter() : PreviousMalloc(GMalloc)
+{
+	check(IsInGameThread());
+	checkf(PreviousMalloc != &GCountingMalloc, TEXT("FScopedAllocationCounter scopes can't be nested."));
+	GCountingMalloc.InnerMalloc = PreviousMalloc;
+	GCountingMalloc.Allocations = 0;
+	GCountingMalloc.Frees = 0;
+	GMalloc = &GCountingMalloc;
+}
+
+FScopedAllocationCounter::~FScopedAllocationCounter()
+{
+	GMalloc = PreviousMalloc;
+}
+
+int64 FScopedAllocationCounter::GetAllocations() const
+{
+	return GCountingMalloc.Allocations;
+}
+
+int64 FScopedAllocationCounter::GetFrees() const
+{
+	return GCountingMalloc.Frees;
+}
@@ -0,0 +1,26 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Counts the heap allocations done by the game thread while in scope, by proxying GMalloc.
+ * Allocations done by other threads go through the proxy, but they aren't counted.
+ * Scopes can't be nested.
+ */
+class TESTWORLD_API FScopedAllocationCounter
+{
+	FMalloc* PreviousMalloc;
+
+public:
+	FScopedAllocationCounter();
+	~FScopedAllocationCounter();
+
+	FScopedAllocationCounter(const FScopedAllocationCounter&) = delete;
+	FScopedAllocationCounter& operator=(const FScopedAllocationCounter&) = delete;
+
+	// Malloc and Realloc calls, including the ones that only shrink or grow in place.
+	int64 GetAllocations() const;
+	int64 GetFrees() const;
+};
@@ -0,0 +1,195 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "AmmoType.h"
+
+#include "Engine/World.h"
+
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+bool FAmmoType::IsPenetrating() const
+{
+	return PenetrationBudget > 0;
+}
+
+bool FAmmoType::Trace(const UWorld* World, const FVector& Start, const FVector& End,
+                      TArray<FHitResult>& OutHits) const
+{
+	OutHits.Reset();
+	if (!IsPenetrating())
+	{
+		if (World->LineTraceSingleByChannel(OutHits.AddDefaulted_GetRef(), Start, End, CollisionChannel))
+		{
+			return true;
+		}
+		OutHits.Reset();
+		return false;
+	}
+
+	// A single multi-hit trace: responding with overlap to everything turns the blocking hits into touches,
+	// so the trace doesn't stop at the first one. It's only as long as the budget can carry the round,
+	// which bounds the geometry it can collect.
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponSystemPenetration), false);
+	QueryParams.bReturnPhysicalMaterial = true;
+	const FCollisionResponseParams ResponseParams(ECR_Overlap);
+	World->LineTraceMultiByChannel(OutHits, Start, ClampPenetrationTraceEnd(Start, End), CollisionChannel, QueryParams,
+	                               ResponseParams);
+
+	// Only what would have blocked the round is a layer. The hits are sorted by distance,
+	// the ones past where the budget or MaxPenetratedLayers stop the round are dropped.
+	float RemainingBudget = PenetrationBudget;
+	int32 Layers = 0;
+	for (int32 Index = 0; Index < OutHits.Num() && Layers <= MaxPenetratedLayers && RemainingBudget >= 0; ++Index)
+	{
+		const UPrimitiveComponent* Component = OutHits[Index].GetComponent();
+		if (!Component || Component->GetCollisionResponseToChannel(CollisionChannel) != ECR_Block)
+		{
+			continue;
+		}
+
+		if (Layers != Index)
+		{
+			OutHits[Layers] = MoveTemp(OutHits[Index]);
+		}
+		FHitResult& Hit = OutHits[Layers++];
+		Hit.bBlockingHit = true;
+		RemainingBudget -= GetPenetrationCost(Hit);
+	}
+	OutHits.SetNum(Layers, false);
+	return !OutHits.IsEmpty();
+}
+
+FVector FAmmoType::ClampPenetrationTraceEnd(const FVector& Start, const FVector& End) const
+{
+	const double Range = static_cast<double>(PenetrationBudget) * PenetrationRangePerBudget;
+	return Range < FVector::Distance(Start, End) ? Start + (End - Start).GetSafeNormal() * Range : End;
+}
+
+float FAmmoType::GetPenetrationCost(const FHitResult& Hit) const
+{
+	const EPhysicalSurface Surface = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+	if (const float* Cost = PenetrationCostPerSurface.Find(Surface))
+	{
+		return *Cost;
+	}
+	return DefaultPenetrationCost;
+}
+
+void FAmmoType::BakeDamageFalloff()
+{
+	if (IsHitScan && DamageFalloffSamples > 0)
+	{
+		DamageFalloff.Bake(Damage, MaximumDistance, DamageFalloffSamples);
+	}
+	else
+	{
+		DamageFalloff.Reset();
+	}
+}
+
+float FAmmoType::GetDamageAtDistance(float Distance) const
+{
+	return DamageFalloff.IsBaked() ? DamageFalloff.Evaluate(Distance) : Damage.GetValueAtLevel(Distance);
+}
+
+bool FAmmoType::IsBallistic() const
+{
+	return IsHitScan && UseBallisticTrajectory;
+}
+
+FVector FAmmoType::GetBallisticPosition(const FVector& Start, const FVector& Velocity, const FVector& Gravity,
+                                        double Time) const
+{
+	if (BallisticDrag <= 0)
+	{
+		return Start + Velocity * Time + 0.5 * Gravity * FMath::Square(Time);
+	}
+
+	// Closed form of dv/dt = g - k * v
+	const double K = BallisticDrag;
+	const FVector TerminalVelocity = Gravity / K;
+	return Start + (Velocity - TerminalVelocity) * ((1 - FMath::Exp(-K * Time)) / K) + TerminalVelocity * Time;
+}
+
+bool FAmmoType::TraceBallistic(const UWorld* World, const FVector& Start, const FVector& Direction,
+                               FHitResult& OutHit, double& OutFlightTime) const
+{
+	const FVector Velocity = Direction * MuzzleSpeed;
+	const FVector Gravity(0, 0, World->GetGravityZ() * BallisticGravityScale);
+	const int32 Segments = FMath::Max(1, BallisticTraceSegments);
+	const double SegmentTime = MaxFlightTime / Segments;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponSystemBallistic), false);
+	double PathLength = 0;
+	FVector SegmentStart = Start;
+	for (int32 Segment = 1; Segment <= Segments && PathLength < MaximumDistance; ++Segment)
+	{
+		FVector SegmentEnd = GetBallisticPosition(Start, Velocity, Gravity, Segment * SegmentTime);
+		const double SegmentLength = FVector::Distance(SegmentStart, SegmentEnd);
+		// The last segment is clipped to the remaining distance, as a fraction of its length and flight time
+		double SegmentFraction = 1;
+		if (PathLength + SegmentLength > MaximumDistance)
+		{
+			SegmentFraction = (MaximumDistance - PathLength) / SegmentLength;
+			SegmentEnd = FMath::Lerp(SegmentStart, SegmentEnd, SegmentFraction);
+		}
+		if (World->LineTraceSingleByChannel(OutHit, SegmentStart, SegmentEnd, CollisionChannel, QueryParams))
+		{
+			OutFlightTime = (Segment - 1 + OutHit.Time * SegmentFraction) * SegmentTime;
+			OutHit.Distance += PathLength;
+			return true;
+		}
+		PathLength += SegmentLength * SegmentFraction;
+		SegmentStart = SegmentEnd;
+	}
+	return false;
+}
+
+bool FAmmoType::HasSpread() const
+{
+	return PelletCount > 1 || SpreadHalfAngle > 0;
+}
+
+void FAmmoType::GeneratePelletDirections(const FVector& Forward, FRandomStream& Stream,
+                                         TArrayView<FVector> OutDirections) const
+{
+	const int32 Count = OutDirections.Num();
+	if (Count == 0)
+	{
+		return;
+	}
+
+	// Each pellet is a point on the spherical cap: U picks the ring, V the angle along it.
+	// They're kept in X and Y of the output until the directions are computed in place.
+	if (UseFixedSpreadPattern)
+	{
+		// Golden angle spiral, the first pellet goes straight ahead
+		constexpr float GoldenRatioConjugate = 0.61803398875f;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			OutDirections[Index].X = static_cast<float>(Index) / Count;
+			OutDirections[Index].Y = FMath::Frac(Index * GoldenRatioConjugate);
+		}
+	}
+	else
+	{
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			OutDirections[Index].X = Stream.GetFraction();
+			OutDirections[Index].Y = Stream.GetFraction();
+		}
+	}
+
+	// Lerping the cosine keeps the distribution uniform over the cap's area
+	const float OneMinusCosHalfAngle = 1 - FMath::Cos(FMath::DegreesToRadians(SpreadHalfAngle));
+	const FQuat Rotation = Forward.ToOrientationQuat();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const float U = OutDirections[Index].X;
+		const float V = OutDirections[Index].Y;
+		const float CosTheta = 1 - U * OneMinusCosHalfAngle;
+		const float SinTheta = FMath::Sqrt(FMath::Max(0.f, 1 - CosTheta * CosTheta));
+		float SinPhi, CosPhi;
+		FMath::SinCos(&SinPhi, &CosPhi, UE_TWO_PI * V);
+		OutDirections[Index] = Rotation.RotateVector(FVector(CosTheta, SinTheta * CosPhi, SinTheta * SinPhi));
+	}
+}
@@ -0,0 +1,58 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "BallisticImpactSubsystem.h"
+
+#include "BallisticWeaponComponent.h"
+#include "WeaponSystemTrace.h"
+
+void UBallisticImpactSubsystem::Deinitialize()
+{
+	Impacts.Empty();
+	Super::Deinitialize();
+}
+
+void UBallisticImpactSubsystem::Tick(float DeltaTime)
+{
+	ApplyImpactsDueBy(GetWorld()->TimeSeconds);
+}
+
+bool UBallisticImpactSubsystem::IsTickable() const
+{
+	return !Impacts.IsEmpty();
+}
+
+TStatId UBallisticImpactSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBallisticImpactSubsystem, STATGROUP_Tickables);
+}
+
+void UBallisticImpactSubsystem::Schedule(UBallisticWeaponComponent* Weapon, double ImpactTimestamp,
+                                         const FHitResult& Hit)
+{
+	check(Weapon);
+	Impacts.HeapPush({Weapon, ImpactTimestamp, Hit});
+}
+
+void UBallisticImpactSubsystem::ApplyImpactsDueBy(double Timestamp)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Impacts", WeaponSystemChannel);
+
+	FImpact Impact;
+	while (!Impacts.IsEmpty() && Impacts.HeapTop().Timestamp <= Timestamp)
+	{
+		Impacts.HeapPop(Impact, false);
+		// The weapon could have been destroyed while the round was flying
+		if (UBallisticWeaponComponent* Weapon = Impact.Weapon.Get())
+		{
+			Weapon->AddHitScanDamage(Impact.Hit);
+			Weapon->ApplyPendingHitScanDamage();
+			// Reports the hit to the native listeners
+			Weapon->NotifyStatusUpdate();
+		}
+	}
+}
+
+int32 UBallisticImpactSubsystem::Num() const
+{
+	return Impacts.Num();
+}
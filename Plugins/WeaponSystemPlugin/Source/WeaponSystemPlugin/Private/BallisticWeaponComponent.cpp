@@ -3,18 +3,58 @@
 
 #include "BallisticWeaponComponent.h"
 
+#include "BallisticImpactSubsystem.h"
 #include "Components/ArrowComponent.h"
+#include "DamageAggregationSubsystem.h"
 #include "DrawDebugHelpers.h"
+#include "HitboxBVHSubsystem.h"
+#include "HitScanBatchSubsystem.h"
 #include "LogWeaponSystem.h"
+#include "ProjectileSimulationSubsystem.h"
+#include "RewindHistorySubsystem.h"
+#include "WeaponSimulationSubsystem.h"
 #include "WeaponSystemTrace.h"
 
+#include "TimerManager.h"
+
 #include "Engine/DamageEvents.h"
 
 #include "Logging/StructuredLog.h"
 
 #include "ProfilingDebugging/MiscTrace.h"
 
-#include "ActorPoolSubsystem.h"
+#include "FrameArena.h"
+#include "TypedActorPool.h"
+
+static constexpr int64 NanosecondsPerMinute = 60'000'000'000ll;
+
+static int64 SecondsToNanoseconds(double Seconds)
+{
+	return FMath::FloorToInt64(Seconds * 1e9);
+}
+
+static double NanosecondsToSeconds(int64 Nanoseconds)
+{
+	return Nanoseconds / 1e9;
+}
+
+// Turns each runtime flag into a template argument, the last one included, of the policy returned by Selector.
+template <typename TSelector, bool... Selected, typename... TFlags>
+static auto SelectPolicy(TSelector Selector, bool Flag, TFlags... Flags)
+{
+	if constexpr (sizeof...(TFlags) == 0)
+	{
+		return Flag
+			       ? Selector.template operator()<Selected..., true>()
+			       : Selector.template operator()<Selected..., false>();
+	}
+	else
+	{
+		return Flag
+			       ? SelectPolicy<TSelector, Selected..., true>(Selector, Flags...)
+			       : SelectPolicy<TSelector, Selected..., false>(Selector, Flags...);
+	}
+}
 
 UBallisticWeaponComponent::UBallisticWeaponComponent()
 {
@@ -22,7 +62,8 @@ UBallisticWeaponComponent::UBallisticWeaponComponent()
 	bAutoRegister = true;
 
 	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.bStartWithTickEnabled = true;
+	// Enabled only while firing, see UpdateTickEnabled()
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 	PrimaryComponentTick.TickInterval = 0;
 
 #if WITH_EDITORONLY_DATA
@@ -46,6 +87,13 @@ void UBallisticWeaponComponent::BeginPlay()
 	UE_LOGFMT(LogWeaponSystem, Verbose, "UBallisticWeaponComponent `{Name}` BeginPlay.", GetFName());
 	SecondsBetweenEachShot = GetSecondsBetweenShots();
 	LastFireTimestamp = -SecondsBetweenEachShot;
+	FiringEpochNs = SecondsToNanoseconds(LastFireTimestamp);
+	NextShotIndex = 1;
+	PreviousMuzzleTransform = GetComponentTransform();
+	PreviousMuzzleTimestamp = 0;
+	AmmoType.BakeDamageFalloff();
+	ProjectileRoundsFired = 0;
+	SpreadStream.Initialize(AmmoType.SpreadSeed != 0 ? AmmoType.SpreadSeed : FMath::Rand());
 	Status = HasEnoughAmmoToFire() ? EBallisticWeaponStatus::Ready : EBallisticWeaponStatus::WaitingReload;
 	StatusNotificationQueue = {};
 	if (FiringStrategy == EBallisticWeaponFiringStrategy::Automatic)
@@ -58,6 +106,34 @@ void UBallisticWeaponComponent::BeginPlay()
 	Super::BeginPlay();
 }
 
+void UBallisticWeaponComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(ReloadTimerHandle);
+		if (SimulationIndex != INDEX_NONE)
+		{
+			World->GetSubsystem<UWeaponSimulationSubsystem>()->Unregister(this);
+		}
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void UBallisticWeaponComponent::AddListener(IBallisticWeaponListener* Listener)
+{
+	check(Listener);
+	Listeners.AddUnique(Listener);
+}
+
+void UBallisticWeaponComponent::RemoveListener(IBallisticWeaponListener* Listener)
+{
+	if (Listeners.RemoveSingle(Listener) > 0 && Listeners.IsEmpty())
+	{
+		PendingShotTimestamps.Reset();
+		PendingShotHits.Reset();
+	}
+}
+
 EBallisticWeaponStatus UBallisticWeaponComponent::GetStatus() const
 {
 	return Status;
@@ -73,40 +149,68 @@ void UBallisticWeaponComponent::SetFireRate(int NewFireRateInRpm)
 #endif
 
 	TRACE_BOOKMARK(TEXT("BallisticWeapon.SetFireRate(%d): %s"), NewFireRateInRpm, *GetNameSafe(GetOwner()));
+	// The schedule restarts from the last shot, with the new interval
+	if (NextShotIndex > 0)
+	{
+		FiringEpochNs = GetShotTimestampNs(NextShotIndex - 1);
+		NextShotIndex = 1;
+	}
 	FireRateRpm = NewFireRateInRpm;
 	SecondsBetweenEachShot = GetSecondsBetweenShots();
 }
 
 void UBallisticWeaponComponent::FireOnce()
 {
-	if (Status == EBallisticWeaponStatus::Ready && HasEnoughAmmoToFire() && HasEnoughTimePassedFromLastShot())
+#if !UE_BUILD_SHIPPING
+	EnsureFirePolicyIsCurrent();
+#endif
+	(this->*FireOncePolicy)();
+}
+
+void UBallisticWeaponComponent::StartFiring()
+{
+#if !UE_BUILD_SHIPPING
+	EnsureFirePolicyIsCurrent();
+#endif
+	(this->*StartFiringPolicy)();
+}
+
+template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+void UBallisticWeaponComponent::FireOnceWith()
+{
+	if (Status == EBallisticWeaponStatus::Ready && (InfiniteAmmo || CurrentMagazine >= AmmoUsedEachShot)
+		&& IsNextShotDue<Strategy>())
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon FireOnce", WeaponSystemChannel);
-		if (IsBurstFire)
+		if constexpr (IsBurst)
 		{
 			Status = EBallisticWeaponStatus::Firing;
 			StatusNotificationQueue.NotifyOnFiringStarted |= 1;
 		}
-		Fire();
-		UpdateMagazineAfterFiring();
+		Fire<IsBurst>(StartFiringSequence());
+		UpdateMagazineAfterFiring<InfiniteAmmo>();
 		NotifyStatusUpdate();
+		UpdateTickEnabled();
 	}
 }
 
-void UBallisticWeaponComponent::StartFiring()
+template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+void UBallisticWeaponComponent::StartFiringWith()
 {
-	if (Status == EBallisticWeaponStatus::Ready && HasEnoughAmmoToFire() && HasEnoughTimePassedFromLastShot())
+	if (Status == EBallisticWeaponStatus::Ready && (InfiniteAmmo || CurrentMagazine >= AmmoUsedEachShot)
+		&& IsNextShotDue<Strategy>())
 	{
 		TRACE_BOOKMARK(TEXT("BallisticWeapon.StartFiring: %s"), *GetNameSafe(GetOwner()));
 		Status = EBallisticWeaponStatus::Firing;
 		StatusNotificationQueue.NotifyOnFiringStarted |= 1;
-		if (IsBurstFire)
+		if constexpr (IsBurst)
 		{
 			CurrentBurstFiringCount = ShotsFiredDuringBurstFire;
 		}
-		Fire();
-		UpdateMagazineAfterFiring();
+		Fire<IsBurst>(StartFiringSequence());
+		UpdateMagazineAfterFiring<InfiniteAmmo>();
 		NotifyStatusUpdate();
+		UpdateTickEnabled();
 	}
 }
 
@@ -119,6 +223,7 @@ void UBallisticWeaponComponent::StopFiring()
 		StatusNotificationQueue.NotifyOnFiringStopped |= 1;
 		StatusNotificationQueue.NotifyOnReloadRequested |= Status == EBallisticWeaponStatus::WaitingReload;
 		NotifyStatusUpdate();
+		UpdateTickEnabled();
 	}
 }
 
@@ -126,16 +231,32 @@ void UBallisticWeaponComponent::StartReloading()
 {
 	Status = EBallisticWeaponStatus::Reloading;
 	StatusNotificationQueue.NotifyOnReloadStarted |= 1;
-	ReloadTimestamp = GetWorld()->TimeSeconds + SecondsToReload;
+
+	// A zero rate would clear the timer, so an instant reload completes on the next frame, like it did when polling.
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (SecondsToReload > 0)
+	{
+		TimerManager.SetTimer(ReloadTimerHandle, this, &UBallisticWeaponComponent::CompleteReloading, SecondsToReload);
+	}
+	else
+	{
+		TimerManager.ClearTimer(ReloadTimerHandle);
+		ReloadTimerHandle = TimerManager.SetTimerForNextTick(this, &UBallisticWeaponComponent::CompleteReloading);
+	}
+
+	NotifyStatusUpdate();
+	UpdateTickEnabled();
 }
 
 void UBallisticWeaponComponent::CancelReloading()
 {
 	if (Status == EBallisticWeaponStatus::Reloading)
 	{
+		GetWorld()->GetTimerManager().ClearTimer(ReloadTimerHandle);
 		Status = HasEnoughAmmoToFire() ? EBallisticWeaponStatus::Ready : EBallisticWeaponStatus::WaitingReload;
 		StatusNotificationQueue.NotifyOnReloadCanceled |= 1;
 		StatusNotificationQueue.NotifyOnReloadRequested |= Status == EBallisticWeaponStatus::WaitingReload;
+		NotifyStatusUpdate();
 	}
 }
 
@@ -152,172 +273,733 @@ bool UBallisticWeaponComponent::HasEnoughAmmoToFire() const
 
 bool UBallisticWeaponComponent::HasEnoughTimePassedFromLastShot() const
 {
-	switch (FiringStrategy)
+	return FiringStrategy == EBallisticWeaponFiringStrategy::TimestampIntegerBased
+		       ? IsNextShotDue<EBallisticWeaponFiringStrategy::TimestampIntegerBased>()
+		       : IsNextShotDue<EBallisticWeaponFiringStrategy::Timestamp>();
+}
+
+template <EBallisticWeaponFiringStrategy Strategy>
+bool UBallisticWeaponComponent::IsNextShotDue() const
+{
+	if constexpr (Strategy == EBallisticWeaponFiringStrategy::TimestampIntegerBased)
+	{
+		return SecondsToNanoseconds(GetWorld()->TimeSeconds) >= GetShotTimestampNs(NextShotIndex);
+	}
+	else
 	{
-	default:
-	case EBallisticWeaponFiringStrategy::Timestamp:
-	case EBallisticWeaponFiringStrategy::TimestampWithAccumulator:
-	case EBallisticWeaponFiringStrategy::TimestampIntegerBased:
 		return GetWorld()->TimeSeconds >= LastFireTimestamp + SecondsBetweenEachShot;
 	}
 }
 
 void UBallisticWeaponComponent::SetFiringStrategy(EBallisticWeaponFiringStrategy NewStrategy)
 {
-	check(NewStrategy != EBallisticWeaponFiringStrategy::TimestampIntegerBased);
 	FiringStrategy = NewStrategy;
-	if (NewStrategy == EBallisticWeaponFiringStrategy::TimestampWithAccumulator)
+	SelectFirePolicy();
+}
+
+void UBallisticWeaponComponent::SetHasInfiniteAmmo(bool NewHasInfiniteAmmo)
+{
+	HasInfiniteAmmo = NewHasInfiniteAmmo;
+	if (HasBegunPlay())
+	{
+		SelectFirePolicy();
+	}
+}
+
+void UBallisticWeaponComponent::SetHasInfiniteAmmoReserve(bool NewHasInfiniteAmmoReserve)
+{
+	HasInfiniteAmmoReserve = NewHasInfiniteAmmoReserve;
+	if (HasBegunPlay())
+	{
+		SelectFirePolicy();
+	}
+}
+
+void UBallisticWeaponComponent::SetReloadingDiscardsEntireMagazine(bool NewReloadingDiscardsEntireMagazine)
+{
+	ReloadingDiscardsEntireMagazine = NewReloadingDiscardsEntireMagazine;
+	if (HasBegunPlay())
+	{
+		SelectFirePolicy();
+	}
+}
+
+void UBallisticWeaponComponent::SetIsBurstFire(bool NewIsBurstFire)
+{
+	IsBurstFire = NewIsBurstFire;
+	if (HasBegunPlay())
+	{
+		SelectFirePolicy();
+	}
+}
+
+void UBallisticWeaponComponent::SetAmmoType(const FAmmoType& NewAmmoType)
+{
+	AmmoType = NewAmmoType;
+	if (HasBegunPlay())
+	{
+		AmmoType.BakeDamageFalloff();
+		SelectFirePolicy();
+	}
+}
+
+void UBallisticWeaponComponent::SetUseBatchedHitScan(bool NewUseBatchedHitScan)
+{
+	UseBatchedHitScan = NewUseBatchedHitScan;
+	if (HasBegunPlay())
+	{
+		SelectFirePolicy();
+	}
+}
+
+void UBallisticWeaponComponent::SetUseHitboxes(bool NewUseHitboxes)
+{
+	UseHitboxes = NewUseHitboxes;
+}
+
+void UBallisticWeaponComponent::SetUseServerRewind(bool NewUseServerRewind)
+{
+	UseServerRewind = NewUseServerRewind;
+}
+
+void UBallisticWeaponComponent::SetUseDamageAggregation(bool NewUseDamageAggregation)
+{
+	UseDamageAggregation = NewUseDamageAggregation;
+}
+
+template <EBallisticWeaponFiringStrategy Strategy>
+void UBallisticWeaponComponent::SelectTriggerPolicies()
+{
+	FireOncePolicy = SelectPolicy([]<bool... Flags>() { return &ThisClass::FireOnceWith<Strategy, Flags...>; },
+	                              IsBurstFire, HasInfiniteAmmo);
+	StartFiringPolicy = SelectPolicy([]<bool... Flags>() { return &ThisClass::StartFiringWith<Strategy, Flags...>; },
+	                                 IsBurstFire, HasInfiniteAmmo);
+	SimulateFiringPolicy = SelectPolicy([]<bool... Flags>() { return &ThisClass::SimulateFiringWith<Strategy, Flags...>; },
+	                                    IsBurstFire, HasInfiniteAmmo);
+}
+
+void UBallisticWeaponComponent::SelectFirePolicy()
+{
+	switch (FiringStrategy)
+	{
+	case EBallisticWeaponFiringStrategy::TimestampWithAccumulator:
+		SelectTriggerPolicies<EBallisticWeaponFiringStrategy::TimestampWithAccumulator>();
+		break;
+	case EBallisticWeaponFiringStrategy::TimestampIntegerBased:
+		SelectTriggerPolicies<EBallisticWeaponFiringStrategy::TimestampIntegerBased>();
+		break;
+	default:
+		SelectTriggerPolicies<EBallisticWeaponFiringStrategy::Timestamp>();
+		break;
+	}
+
+	ReloadMagazinePolicy = SelectPolicy([]<bool... Flags>() { return &ThisClass::ReloadMagazineWith<Flags...>; },
+	                                    ReloadingDiscardsEntireMagazine, HasInfiniteAmmoReserve);
+
+	if (!AmmoType.IsHitScan)
 	{
-		MissedShotsThisFrame = 0;
+		FireRoundsPolicy = &ThisClass::FireProjectileRounds;
+#if !UE_BUILD_SHIPPING
+		if (UseServerRewind)
+		{
+			UE_LOGFMT(LogWeaponSystem, Warning, "{Weapon} uses projectile rounds, they aren't rewound by UseServerRewind.",
+			          GetPathName());
+		}
+		const AProjectileBase* Archetype = AmmoType.ProjectileClass
+			                                   ? AmmoType.ProjectileClass->GetDefaultObject<AProjectileBase>()
+			                                   : nullptr;
+		if (Archetype && !Archetype->CanBeSimulatedWithoutActor()
+			&& (Archetype->SimulateWithoutActor || AmmoType.TracerEveryNthRound > 1))
+		{
+			UE_LOGFMT(LogWeaponSystem, Warning,
+			          "{Class} uses homing or a proximity fuse, every round spawns an Actor instead of being simulated.",
+			          AmmoType.ProjectileClass->GetName());
+		}
+#endif
 	}
+	else if (AmmoType.IsBallistic())
+	{
+		FireRoundsPolicy = &ThisClass::FireBallisticRounds;
+#if !UE_BUILD_SHIPPING
+		if (UseServerRewind)
+		{
+			UE_LOGFMT(LogWeaponSystem, Warning, "{Weapon} uses ballistic rounds, they aren't rewound by UseServerRewind.",
+			          GetPathName());
+		}
+#endif
+	}
+	else if (UseBatchedHitScan)
+	{
+		FireRoundsPolicy = &ThisClass::FireBatchedHitScanRounds;
+	}
+	else
+	{
+		FireRoundsPolicy = &ThisClass::FireHitScanRounds;
+	}
+
+#if !UE_BUILD_SHIPPING
+	SelectedFirePolicySettings = MakeFirePolicySettings();
+#endif
+}
+
+#if !UE_BUILD_SHIPPING
+UBallisticWeaponComponent::FFirePolicySettings UBallisticWeaponComponent::MakeFirePolicySettings() const
+{
+	return {
+		FiringStrategy, IsBurstFire, HasInfiniteAmmo, HasInfiniteAmmoReserve, ReloadingDiscardsEntireMagazine,
+		AmmoType.IsHitScan, AmmoType.IsBallistic(), UseBatchedHitScan
+	};
 }
 
+void UBallisticWeaponComponent::EnsureFirePolicyIsCurrent() const
+{
+	ensureMsgf(SelectedFirePolicySettings == MakeFirePolicySettings(),
+	           TEXT("%s: fire settings assigned while playing without their setters, call SelectFirePolicy() after them."),
+	           *GetPathName());
+}
+#endif
+
 void UBallisticWeaponComponent::TickComponent(float DeltaTime, ELevelTick TickType,
                                               FActorComponentTickFunction* ThisTickFunction)
 {
 	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_Tick);
 	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Tick", WeaponSystemChannel);
 
+	SimulateFiring();
+}
+
+void UBallisticWeaponComponent::SimulateFiring()
+{
+#if !UE_BUILD_SHIPPING
+	EnsureFirePolicyIsCurrent();
+#endif
+	(this->*SimulateFiringPolicy)();
+}
+
+template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+void UBallisticWeaponComponent::SimulateFiringWith()
+{
 	if (Status == EBallisticWeaponStatus::Firing)
 	{
-		if (HasEnoughAmmoToFire())
+		if (InfiniteAmmo || CurrentMagazine >= AmmoUsedEachShot)
 		{
-			if (HasEnoughTimePassedFromLastShot())
+			if (IsNextShotDue<Strategy>() && (!IsBurst || CurrentBurstFiringCount > 0))
 			{
-				if (!IsBurstFire || CurrentBurstFiringCount > 0)
+				if constexpr (Strategy == EBallisticWeaponFiringStrategy::Timestamp)
 				{
-					Fire();
-					UpdateMagazineAfterFiring();
+					Fire<IsBurst>(MakeShotFromMuzzle());
+					UpdateMagazineAfterFiring<InfiniteAmmo>();
+				}
+				else
+				{
+					FireScheduledShots<Strategy, IsBurst, InfiniteAmmo>();
 				}
 			}
 		}
 		else
 		{
+			StatusNotificationQueue.NotifyOnFiringStopped |= Status == EBallisticWeaponStatus::Firing;
 			Status = EBallisticWeaponStatus::WaitingReload;
 			StatusNotificationQueue.NotifyOnReloadRequested |= 1;
-			StatusNotificationQueue.NotifyOnFiringStopped |= Status == EBallisticWeaponStatus::Firing;
 		}
+
+		PreviousMuzzleTransform = GetComponentTransform();
+		PreviousMuzzleTimestamp = GetWorld()->TimeSeconds;
 	}
-	else if (Status == EBallisticWeaponStatus::Reloading && GetWorld()->TimeSeconds >= ReloadTimestamp)
+
+	NotifyStatusUpdate();
+	UpdateTickEnabled();
+}
+
+void UBallisticWeaponComponent::CompleteReloading()
+{
+	if (Status != EBallisticWeaponStatus::Reloading)
 	{
-		ReloadMagazine();
-		Status = HasEnoughAmmoToFire() ? EBallisticWeaponStatus::Ready : EBallisticWeaponStatus::WaitingReload;
-		StatusNotificationQueue.NotifyOnReloadRequested |= Status == EBallisticWeaponStatus::WaitingReload;
+		return;
 	}
 
+	ReloadMagazine();
+	Status = HasEnoughAmmoToFire() ? EBallisticWeaponStatus::Ready : EBallisticWeaponStatus::WaitingReload;
+	StatusNotificationQueue.NotifyOnReloadRequested |= Status == EBallisticWeaponStatus::WaitingReload;
 	NotifyStatusUpdate();
 }
 
-void UBallisticWeaponComponent::Fire()
+void UBallisticWeaponComponent::UpdateTickEnabled()
+{
+	const bool ShouldTick = Status == EBallisticWeaponStatus::Firing;
+	if (UseSimulationSubsystem)
+	{
+		if (ShouldTick != (SimulationIndex != INDEX_NONE))
+		{
+			UWeaponSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UWeaponSimulationSubsystem>();
+			check(Simulation);
+			ShouldTick ? Simulation->Register(this) : Simulation->Unregister(this);
+		}
+	}
+	else if (ShouldTick != IsComponentTickEnabled())
+	{
+		SetComponentTickEnabled(ShouldTick);
+	}
+}
+
+FBallisticWeaponShot UBallisticWeaponComponent::MakeShotFromMuzzle() const
+{
+	return {GetWorld()->TimeSeconds, GetComponentLocation(), GetForwardVector()};
+}
+
+FBallisticWeaponShot UBallisticWeaponComponent::StartFiringSequence()
+{
+	const FBallisticWeaponShot Shot = MakeShotFromMuzzle();
+	PreviousMuzzleTransform = GetComponentTransform();
+	PreviousMuzzleTimestamp = Shot.Timestamp;
+	FiringEpochNs = SecondsToNanoseconds(Shot.Timestamp);
+	NextShotIndex = 0;
+	return Shot;
+}
+
+int64 UBallisticWeaponComponent::GetShotTimestampNs(int64 ShotIndex) const
+{
+	check(FireRateRpm > 0);
+	// Split to avoid overflowing ShotIndex * NanosecondsPerMinute on long sessions
+	return FiringEpochNs
+		+ (ShotIndex / FireRateRpm) * NanosecondsPerMinute
+		+ (ShotIndex % FireRateRpm) * NanosecondsPerMinute / FireRateRpm;
+}
+
+int64 UBallisticWeaponComponent::GetLastShotIndexDueAt(int64 TimestampNs) const
+{
+	const int64 Elapsed = TimestampNs - FiringEpochNs;
+	if (Elapsed < 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// Lower bound, GetShotTimestampNs rounds down so the next shot could be due too
+	int64 ShotIndex = (Elapsed / NanosecondsPerMinute) * FireRateRpm
+		+ (Elapsed % NanosecondsPerMinute) * FireRateRpm / NanosecondsPerMinute;
+	while (GetShotTimestampNs(ShotIndex + 1) <= TimestampNs)
+	{
+		++ShotIndex;
+	}
+	return ShotIndex;
+}
+
+double UBallisticWeaponComponent::GetNextShotTimestamp() const
+{
+	return FiringStrategy == EBallisticWeaponFiringStrategy::TimestampIntegerBased
+		       ? NanosecondsToSeconds(GetShotTimestampNs(NextShotIndex))
+		       : LastFireTimestamp + SecondsBetweenEachShot;
+}
+
+bool UBallisticWeaponComponent::NeedsFiringUpdate(double Now) const
+{
+	const bool CanShoot = Now >= GetNextShotTimestamp() && (!IsBurstFire || CurrentBurstFiringCount > 0);
+	return !HasEnoughAmmoToFire() || CanShoot;
+}
+
+template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+void UBallisticWeaponComponent::FireScheduledShots()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Schedule Shots", WeaponSystemChannel);
+
+	const double Now = GetWorld()->TimeSeconds;
+	constexpr bool IsIntegerBased = Strategy == EBallisticWeaponFiringStrategy::TimestampIntegerBased;
+	const double FirstShotTimestamp = LastFireTimestamp + SecondsBetweenEachShot;
+	const int64 ShotsDue = IsIntegerBased
+		                       ? GetLastShotIndexDueAt(SecondsToNanoseconds(Now)) - NextShotIndex + 1
+		                       : FMath::FloorToInt64((Now - FirstShotTimestamp) / SecondsBetweenEachShot) + 1;
+	int32 ShotsToFire = static_cast<int32>(FMath::Min<int64>(ShotsDue, MAX_int32));
+	if (!InfiniteAmmo && AmmoUsedEachShot > 0)
+	{
+		ShotsToFire = FMath::Min(ShotsToFire, CurrentMagazine / AmmoUsedEachShot);
+	}
+	if constexpr (IsBurst)
+	{
+		ShotsToFire = FMath::Min(ShotsToFire, CurrentBurstFiringCount);
+	}
+	if (ShotsToFire <= 0)
+	{
+		return;
+	}
+
+	const FTransform CurrentMuzzleTransform = GetComponentTransform();
+	const double FrameDuration = Now - PreviousMuzzleTimestamp;
+	TArrayView<FBallisticWeaponShot> Shots = FFrameArena::Get(GetWorld()).NewArray<FBallisticWeaponShot>(ShotsToFire);
+	for (int32 Index = 0; Index < ShotsToFire; ++Index)
+	{
+		FBallisticWeaponShot& Shot = Shots[Index];
+		Shot.Timestamp = IsIntegerBased
+			                 ? NanosecondsToSeconds(GetShotTimestampNs(NextShotIndex + Index))
+			                 : FirstShotTimestamp + Index * SecondsBetweenEachShot;
+		const double Alpha = FrameDuration > 0
+			                     ? FMath::Clamp((Shot.Timestamp - PreviousMuzzleTimestamp) / FrameDuration, 0.0, 1.0)
+			                     : 1.0;
+		Shot.Location = FMath::Lerp(PreviousMuzzleTransform.GetLocation(), CurrentMuzzleTransform.GetLocation(), Alpha);
+		Shot.Direction = FQuat::Slerp(PreviousMuzzleTransform.GetRotation(), CurrentMuzzleTransform.GetRotation(), Alpha)
+			.GetForwardVector();
+	}
+
+	{
+		// The targets of the frame's shots are rewound once, to where the shooter saw them at the end of the frame,
+		// anywhere the muzzle could reach during it. Their damage waits for the targets to be put back.
+		TOptional<FRewindHistoryScope> Rewind;
+		if (FireRoundsPolicy == &ThisClass::FireHitScanRounds)
+		{
+			const FVector MuzzleTravel = CurrentMuzzleTransform.GetLocation() - PreviousMuzzleTransform.GetLocation();
+			RewindHitScanTargets(Rewind, Now, FSphere(PreviousMuzzleTransform.GetLocation() + MuzzleTravel * 0.5,
+			                                          AmmoType.MaximumDistance + MuzzleTravel.Size() * 0.5));
+		}
+		IsFrameRewound = Rewind.IsSet();
+
+		for (const FBallisticWeaponShot& Shot : Shots)
+		{
+			Fire<IsBurst>(Shot);
+			UpdateMagazineAfterFiring<InfiniteAmmo>();
+			if (Status != EBallisticWeaponStatus::Firing)
+			{
+				break;
+			}
+		}
+		IsFrameRewound = false;
+	}
+	ApplyPendingHitScanDamage();
+}
+
+template <bool IsBurst>
+void UBallisticWeaponComponent::Fire(const FBallisticWeaponShot& Shot)
 {
 	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_Fire);
 	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Fire", WeaponSystemChannel);
 
-	UWorld* World = GetWorld();
-	checkf(World, TEXT("Tried to fire a weapon without a World available."));
-	const FVector MuzzleLocation = GetComponentLocation();
-	const FVector MuzzleDirection = GetForwardVector();
+	checkf(GetWorld(), TEXT("Tried to fire a weapon without a World available."));
 
-	int ShotsToFire = 1;
-	const double Now = World->TimeSeconds;
-	if (FiringStrategy == EBallisticWeaponFiringStrategy::TimestampWithAccumulator)
+	LastFireTimestamp = Shot.Timestamp;
+	++NextShotIndex;
+	if (!Listeners.IsEmpty())
 	{
-		const double Delta = Now - LastFireTimestamp;
-		MissedShotsThisFrame += Delta > 1.0 ? Delta - 1.0 : 0.0;
-		ShotsToFire += FMath::Floor(MissedShotsThisFrame);
-		MissedShotsThisFrame -= ShotsToFire - 1;
+		PendingShotTimestamps.Add(Shot.Timestamp);
 	}
 
-	LastFireTimestamp = Now;
+	(this->*FireRoundsPolicy)(Shot);
+
+	StatusNotificationQueue.NotifyOnShotFired |= 1;
 
-	if (AmmoType.IsHitScan)
+	if constexpr (IsBurst)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon HitScan", WeaponSystemChannel);
+		if (--CurrentBurstFiringCount <= 0 && Status == EBallisticWeaponStatus::Firing)
+		{
+			Status = HasEnoughAmmoToFire() ? EBallisticWeaponStatus::Ready : EBallisticWeaponStatus::WaitingReload;
+			StatusNotificationQueue.NotifyOnFiringStopped |= 1;
+			StatusNotificationQueue.NotifyOnReloadRequested |= Status == EBallisticWeaponStatus::WaitingReload;
+		}
+	}
+}
+
+TArrayView<const FVector> UBallisticWeaponComponent::MakePelletDirections(const FBallisticWeaponShot& Shot)
+{
+	if (!AmmoType.HasSpread())
+	{
+		return MakeArrayView(&Shot.Direction, 1);
+	}
+
+	TArrayView<FVector> Directions = FFrameArena::Get(GetWorld()).NewArray<FVector>(FMath::Max(1, AmmoType.PelletCount));
+	AmmoType.GeneratePelletDirections(Shot.Direction, SpreadStream, Directions);
+	return Directions;
+}
 
 #if WITH_EDITOR
-		if (ShouldDrawLineTraceOnHitScan)
+void UBallisticWeaponComponent::DrawPelletTraces(const FBallisticWeaponShot& Shot,
+                                                 TConstArrayView<FVector> PelletDirections) const
+{
+	if (ShouldDrawLineTraceOnHitScan)
+	{
+		for (const FVector& Direction : PelletDirections)
 		{
-			DrawDebugLine(World, MuzzleLocation, MuzzleLocation + MuzzleDirection * AmmoType.MaximumDistance,
+			DrawDebugLine(GetWorld(), Shot.Location, Shot.Location + Direction * AmmoType.MaximumDistance,
 			              FColor::Red, false, 1.f, 0, 0.5f);
 		}
+	}
+}
+#endif
+
+void UBallisticWeaponComponent::FireHitScanRounds(const FBallisticWeaponShot& Shot)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon HitScan", WeaponSystemChannel);
+
+	const TArrayView<const FVector> PelletDirections = MakePelletDirections(Shot);
+#if WITH_EDITOR
+	DrawPelletTraces(Shot, PelletDirections);
 #endif
 
+	UWorld* World = GetWorld();
+	FirstPendingHitScanDamageOfShot = PendingHitScanDamage.Num();
+	{
+		// The targets are put back before being damaged
+		TOptional<FRewindHistoryScope> Rewind;
+		if (!IsFrameRewound)
+		{
+			RewindHitScanTargets(Rewind, Shot.Timestamp, FSphere(Shot.Location, AmmoType.MaximumDistance));
+		}
+
 		// Async line trace is too imprecise, so we've chosen to use the sync one that yields very close results to expected RPMs
-		FHitResult HitResult;
-		if (World->LineTraceSingleByChannel(
-			HitResult,
-			MuzzleLocation,
-			MuzzleLocation + MuzzleDirection * AmmoType.MaximumDistance,
-			AmmoType.CollisionChannel))
+		for (const FVector& Direction : PelletDirections)
 		{
-#if WITH_EDITOR
-			if (ShouldLogLineTraceHits)
+			if (TraceHitScan(World, Shot.Location, Shot.Location + Direction * AmmoType.MaximumDistance, HitScanHits))
 			{
-				UE_LOGFMT(LogWeaponSystem, Display, "Hit {Actor}, {Distance} cm far",
-				          HitResult.GetActor()->GetName(),
-				          HitResult.Distance);
+				ResolveHitScanHits(HitScanHits);
 			}
+		}
+	}
+	if (!IsFrameRewound)
+	{
+		ApplyPendingHitScanDamage();
+	}
+}
+
+void UBallisticWeaponComponent::RewindHitScanTargets(TOptional<FRewindHistoryScope>& Rewind, double Timestamp,
+                                                     const FSphere& Region)
+{
+	if (UseServerRewind && RewindLatency > 0)
+	{
+		// Actors out of range can't be hit, so they aren't moved
+		Rewind.Emplace(GetWorld()->GetSubsystem<URewindHistorySubsystem>(), Timestamp - RewindLatency, GetOwner(),
+		               Region);
+	}
+}
+
+void UBallisticWeaponComponent::FireBatchedHitScanRounds(const FBallisticWeaponShot& Shot)
+{
+	const TArrayView<const FVector> PelletDirections = MakePelletDirections(Shot);
+#if WITH_EDITOR
+	DrawPelletTraces(Shot, PelletDirections);
 #endif
 
-			if (AActor* ActorHit = HitResult.GetActor(); ActorHit && ActorHit->CanBeDamaged())
-			{
-				AActor* Owner = GetOwner();
-				const FDamageEvent DamageEvent{AmmoType.DamageType};
-				const float DamageValue = AmmoType.Damage.GetValueAtLevel(HitResult.Distance);
+	UHitScanBatchSubsystem* HitScanBatch = GetWorld()->GetSubsystem<UHitScanBatchSubsystem>();
+	for (const FVector& Direction : PelletDirections)
+	{
+		HitScanBatch->Enqueue(this, {Shot.Timestamp, Shot.Location, Direction});
+	}
+}
 
-				// ReSharper disable CppDefaultCaseNotHandledInSwitchStatement
-				switch (ShotsToFire)
-				// ReSharper restore CppDefaultCaseNotHandledInSwitchStatement
-				{
-				case 2:
-					ActorHit->TakeDamage(DamageValue, DamageEvent, Owner->GetInstigatorController(), Owner);
-				case 1:
-					ActorHit->TakeDamage(DamageValue, DamageEvent, Owner->GetInstigatorController(), Owner);
-					break;
-				}
+void UBallisticWeaponComponent::FireBallisticRounds(const FBallisticWeaponShot& Shot)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon HitScan", WeaponSystemChannel);
+
+	const TArrayView<const FVector> PelletDirections = MakePelletDirections(Shot);
+#if WITH_EDITOR
+	DrawPelletTraces(Shot, PelletDirections);
+#endif
+
+	UWorld* World = GetWorld();
+	UBallisticImpactSubsystem* BallisticImpacts = World->GetSubsystem<UBallisticImpactSubsystem>();
+	FHitResult Hit;
+	double FlightTime;
+	for (const FVector& Direction : PelletDirections)
+	{
+		if (AmmoType.TraceBallistic(World, Shot.Location, Direction, Hit, FlightTime))
+		{
+			BallisticImpacts->Schedule(this, Shot.Timestamp + FlightTime, Hit);
+		}
+	}
+}
+
+void UBallisticWeaponComponent::FireProjectileRounds(const FBallisticWeaponShot& Shot)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Projectile", WeaponSystemChannel);
+
+#if !UE_BUILD_SHIPPING
+	if (!AmmoType.ProjectileClass)
+	{
+		UE_LOGFMT(LogWeaponSystem, Error, "AmmoType can't fire a projectile if ProjectileClass isn't set!");
+	}
+#endif
+	check(AmmoType.ProjectileClass);
+
+	UWorld* World = GetWorld();
+	AProjectileBase* Archetype = AmmoType.ProjectileClass->GetDefaultObject<AProjectileBase>();
+	UProjectileSimulationSubsystem* ProjectileSimulation = World->GetSubsystem<UProjectileSimulationSubsystem>();
+	TActorPool<AProjectileBase> ProjectilePool(World, AmmoType.ProjectileClass);
+
+	FActorSpawnParameters SpawnParameters{};
+	SpawnParameters.Owner = GetOwner();
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const int32 TracerEveryNthRound = FMath::Max(1, AmmoType.TracerEveryNthRound);
+	const bool CanBeSimulatedWithoutActor = Archetype->CanBeSimulatedWithoutActor();
+	for (const FVector& Direction : MakePelletDirections(Shot))
+	{
+		const bool IsTracer = !CanBeSimulatedWithoutActor
+			|| (!Archetype->SimulateWithoutActor && ProjectileRoundsFired++ % TracerEveryNthRound == 0);
+		if (IsTracer)
+		{
+			ProjectilePool.Acquire(FTransform(Direction.ToOrientationQuat(), Shot.Location), SpawnParameters);
+		}
+		else
+		{
+			ProjectileSimulation->Launch(Archetype, Shot.Location, Direction, GetOwner());
+		}
+	}
+}
+
+bool UBallisticWeaponComponent::TraceHitScan(const UWorld* World, const FVector& Start, const FVector& End,
+                                             TArray<FHitResult>& OutHits) const
+{
+	if (!UseHitboxes)
+	{
+		return AmmoType.Trace(World, Start, End, OutHits);
+	}
+	else if (AmmoType.IsPenetrating())
+	{
+		// The hitboxes crossed are layers too, merged by distance with the world geometry.
+		// Each Actor is a single layer, hit by its nearest hitbox.
+		const UHitboxBVHSubsystem* Hitboxes = World->GetSubsystem<UHitboxBVHSubsystem>();
+		const FVector PenetrationEnd = AmmoType.ClampPenetrationTraceEnd(Start, End);
+		AmmoType.Trace(World, Start, PenetrationEnd, OutHits);
+		TArray<const AActor*, TInlineAllocator<8>> IgnoredActors{GetOwner()};
+		for (int32 Layer = 0; Layer <= AmmoType.MaxPenetratedLayers; ++Layer)
+		{
+			FHitResult& HitboxHit = OutHits.AddDefaulted_GetRef();
+			if (!Hitboxes->Raycast(Start, PenetrationEnd, HitboxHit, IgnoredActors))
+			{
+				OutHits.Pop(false);
+				break;
 			}
+			IgnoredActors.Add(HitboxHit.GetActor());
 		}
+		OutHits.Sort([](const FHitResult& A, const FHitResult& B) { return A.Distance < B.Distance; });
+		return !OutHits.IsEmpty();
 	}
 	else
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Projectile", WeaponSystemChannel);
+		// Physics only has to find the world geometry between the muzzle and the hitbox hit, if any
+		const UHitboxBVHSubsystem* Hitboxes = World->GetSubsystem<UHitboxBVHSubsystem>();
+		FHitResult HitboxHit;
+		const bool HasHitHitbox = Hitboxes->Raycast(Start, End, HitboxHit, GetOwner());
+		if (AmmoType.Trace(World, Start, HasHitHitbox ? HitboxHit.Location : End, OutHits))
+		{
+			return true;
+		}
+		if (HasHitHitbox)
+		{
+			OutHits.Add(HitboxHit);
+		}
+		return HasHitHitbox;
+	}
+}
 
-#if !UE_BUILD_SHIPPING
-		if (!AmmoType.ProjectileClass)
+void UBallisticWeaponComponent::ResolveHitScanHits(TConstArrayView<FHitResult> Hits)
+{
+	if (!AmmoType.IsPenetrating())
+	{
+		if (!Hits.IsEmpty())
+		{
+			AddHitScanDamage(Hits[0]);
+		}
+	}
+	else
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Penetration", WeaponSystemChannel);
+		float PenetrationBudget = AmmoType.PenetrationBudget;
+		float DamageMultiplier = 1;
+		int PenetratedLayers = 0;
+		for (const FHitResult& Hit : Hits)
 		{
-			UE_LOGFMT(LogWeaponSystem, Error, "AmmoType can't fire a projectile if ProjectileClass isn't set!");
+			// Only what would have blocked the round is a layer, hitboxes included
+			if (!Hit.bBlockingHit)
+			{
+				continue;
+			}
+
+			AddHitScanDamage(Hit, DamageMultiplier);
+
+			PenetrationBudget -= AmmoType.GetPenetrationCost(Hit);
+			if (PenetrationBudget < 0 || ++PenetratedLayers > AmmoType.MaxPenetratedLayers)
+			{
+				break;
+			}
+			DamageMultiplier *= 1 - AmmoType.DamageAttenuationPerLayer;
 		}
+	}
+}
+
+void UBallisticWeaponComponent::AddHitScanDamage(const FHitResult& HitResult, float DamageMultiplier)
+{
+#if WITH_EDITOR
+	if (ShouldLogLineTraceHits)
+	{
+		UE_LOGFMT(LogWeaponSystem, Display, "Hit {Actor}, {Distance} cm far",
+		          GetNameSafe(HitResult.GetActor()),
+		          HitResult.Distance);
+	}
 #endif
-		check(AmmoType.ProjectileClass);
 
-		FTransform ProjectileTransform;
-		ProjectileTransform.SetLocation(MuzzleLocation);
-		ProjectileTransform.SetRotation(MuzzleDirection.ToOrientationQuat());
+	AActor* ActorHit = HitResult.GetActor();
+	if (!ActorHit || !ActorHit->CanBeDamaged())
+	{
+		return;
+	}
 
-		FActorSpawnParameters SpawnParameters{};
-		SpawnParameters.Owner = GetOwner();
-		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	if (!Listeners.IsEmpty())
+	{
+		PendingShotHits.Add(HitResult);
+	}
 
-		UActorPoolSubsystem::SpawnOrAcquireFromPool(GetWorld(), AmmoType.ProjectileClass, ProjectileTransform,
-		                                            SpawnParameters);
+	const float DamageValue = AmmoType.GetDamageAtDistance(HitResult.Distance) * DamageMultiplier;
+	// A handful of targets per shot at most, a linear search is the cheapest lookup.
+	// The previous shots still pending, while the frame is rewound, are damaged on their own.
+	for (int32 Index = FirstPendingHitScanDamageOfShot; Index < PendingHitScanDamage.Num(); ++Index)
+	{
+		FPendingHitScanDamage& Pending = PendingHitScanDamage[Index];
+		if (Pending.Actor == ActorHit)
+		{
+			Pending.Damage += DamageValue;
+			++Pending.HitCount;
+			return;
+		}
 	}
+	PendingHitScanDamage.Add({ActorHit, DamageValue, 1});
+}
 
-	StatusNotificationQueue.NotifyOnShotFired |= 1;
+void UBallisticWeaponComponent::ApplyPendingHitScanDamage()
+{
+	if (PendingHitScanDamage.IsEmpty())
+	{
+		return;
+	}
 
-	if (IsBurstFire)
+	AActor* Owner = GetOwner();
+	if (UseDamageAggregation)
 	{
-		if (--CurrentBurstFiringCount <= 0 && Status == EBallisticWeaponStatus::Firing)
+		UDamageAggregationSubsystem* DamageAggregation = GetWorld()->GetSubsystem<UDamageAggregationSubsystem>();
+		for (const FPendingHitScanDamage& Pending : PendingHitScanDamage)
 		{
-			Status = HasEnoughAmmoToFire() ? EBallisticWeaponStatus::Ready : EBallisticWeaponStatus::WaitingReload;
-			StatusNotificationQueue.NotifyOnFiringStopped |= 1;
-			StatusNotificationQueue.NotifyOnReloadRequested |= Status == EBallisticWeaponStatus::WaitingReload;
+			if (AActor* ActorHit = Pending.Actor.Get())
+			{
+				DamageAggregation->QueueDamage(ActorHit, Pending.Damage, AmmoType.DamageType,
+				                               Owner->GetInstigatorController(), Owner, Pending.HitCount);
+			}
 		}
 	}
+	else
+	{
+		const FDamageEvent DamageEvent{AmmoType.DamageType};
+		for (const FPendingHitScanDamage& Pending : PendingHitScanDamage)
+		{
+			// Damage dealt to a previous target could have destroyed this one
+			if (AActor* ActorHit = Pending.Actor.Get())
+			{
+				ActorHit->TakeDamage(Pending.Damage, DamageEvent, Owner->GetInstigatorController(), Owner);
+			}
+		}
+	}
+	PendingHitScanDamage.Reset();
+	FirstPendingHitScanDamageOfShot = 0;
 }
 
+template <bool InfiniteAmmo>
 void UBallisticWeaponComponent::UpdateMagazineAfterFiring()
 {
-	if (LIKELY(!HasInfiniteAmmo))
+	if constexpr (!InfiniteAmmo)
 	{
 		SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_UpdateMagazine);
 		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Update Mag", WeaponSystemChannel);
@@ -340,10 +1022,16 @@ void UBallisticWeaponComponent::UpdateMagazineAfterFiring()
 }
 
 void UBallisticWeaponComponent::ReloadMagazine()
+{
+	(this->*ReloadMagazinePolicy)();
+}
+
+template <bool DiscardsMagazine, bool InfiniteReserve>
+void UBallisticWeaponComponent::ReloadMagazineWith()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Reload", WeaponSystemChannel);
 
-	if (ReloadingDiscardsEntireMagazine)
+	if constexpr (DiscardsMagazine)
 	{
 		CurrentMagazine = 0;
 	}
@@ -351,7 +1039,7 @@ void UBallisticWeaponComponent::ReloadMagazine()
 	checkf(MagazineSize >= CurrentMagazine, TEXT("Precondition MagazineSize >= CurrentMagazine (%d >= %d) is false."),
 	       MagazineSize, CurrentMagazine);
 
-	if (LIKELY(!HasInfiniteAmmoReserve))
+	if constexpr (!InfiniteReserve)
 	{
 		const int16 MissingRounds = MagazineSize - CurrentMagazine;
 		const int16 RoundsAvailable = AmmoReserve >= MissingRounds ? MissingRounds : AmmoReserve;
@@ -375,8 +1063,14 @@ void UBallisticWeaponComponent::ReloadMagazine()
 
 void UBallisticWeaponComponent::NotifyStatusUpdate()
 {
+	const FNotifyQueueFlags Notifications = StatusNotificationQueue;
 	if (!HasPendingNotifications())
 	{
+		// The hits of rounds fired earlier could have landed
+		if (!Listeners.IsEmpty())
+		{
+			NotifyListeners(Notifications);
+		}
 		return;
 	}
 
@@ -422,4 +1116,80 @@ void UBallisticWeaponComponent::NotifyStatusUpdate()
 	}
 
 	StatusNotificationQueue = {};
+
+	if (!Listeners.IsEmpty())
+	{
+		NotifyListeners(Notifications);
+	}
+}
+
+void UBallisticWeaponComponent::NotifyListeners(FNotifyQueueFlags Notifications)
+{
+	const bool HasNotifications = std::bit_cast<uint8>(Notifications) != 0;
+	const bool HasPendingShots = !PendingShotTimestamps.IsEmpty() || !PendingShotHits.IsEmpty();
+	if (!HasNotifications && !HasPendingShots)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Ballistic Weapon Notify Listeners", WeaponSystemChannel);
+
+	// A listener could fire, or remove itself, while being notified
+	TArray<double> Timestamps = MoveTemp(PendingShotTimestamps);
+	TArray<FHitResult> Hits = MoveTemp(PendingShotHits);
+	const FBallisticWeaponShotBatch Shots{Timestamps, Hits};
+	const TArray<IBallisticWeaponListener*, TInlineAllocator<2>> ListenersToNotify = Listeners;
+	for (IBallisticWeaponListener* Listener : ListenersToNotify)
+	{
+		// A previous call could have removed it, then destroyed it, so it's looked up before each one
+		const auto IsListening = [this, Listener] { return Listeners.Contains(Listener); };
+		if (HasNotifications && IsListening())
+		{
+			Listener->OnStatusChanged(*this, Status);
+		}
+		if (Notifications.NotifyOnReloadRequested && IsListening())
+		{
+			Listener->OnReloadRequested(*this);
+		}
+		if (Notifications.NotifyOnReloadStarted && IsListening())
+		{
+			Listener->OnReloadStarted(*this);
+		}
+		if (Notifications.NotifyOnReloadCanceled && IsListening())
+		{
+			Listener->OnReloadCanceled(*this);
+		}
+		if (Notifications.NotifyOnReloadCompleted && IsListening())
+		{
+			Listener->OnReloadCompleted(*this);
+		}
+		if (Notifications.NotifyOnReloadFailed && IsListening())
+		{
+			Listener->OnReloadFailed(*this);
+		}
+		if (Notifications.NotifyOnFiringStarted && IsListening())
+		{
+			Listener->OnFiringStarted(*this);
+		}
+		if (Notifications.NotifyOnFiringStopped && IsListening())
+		{
+			Listener->OnFiringStopped(*this);
+		}
+		if (HasPendingShots && IsListening())
+		{
+			Listener->OnShotsFired(*this, Shots);
+		}
+	}
+
+	// Keeps the allocations for the next batch, unless the listeners have queued a new one
+	if (PendingShotTimestamps.IsEmpty())
+	{
+		Timestamps.Reset();
+		PendingShotTimestamps = MoveTemp(Timestamps);
+	}
+	if (PendingShotHits.IsEmpty())
+	{
+		Hits.Reset();
+		PendingShotHits = MoveTemp(Hits);
+	}
 }
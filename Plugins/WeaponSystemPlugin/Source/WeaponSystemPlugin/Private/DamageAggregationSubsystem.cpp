@@ -0,0 +1,124 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "DamageAggregationSubsystem.h"
+
+#include "WeaponSystemTrace.h"
+
+#include "GameFramework/Actor.h"
+#include "GameFramework/Controller.h"
+
+int32 FAggregatedDamageEvent::GetHitCount(const FDamageEvent& DamageEvent)
+{
+	return DamageEvent.IsOfType(ClassID) ? static_cast<const FAggregatedDamageEvent&>(DamageEvent).HitCount : 1;
+}
+
+void UDamageAggregationSubsystem::Deinitialize()
+{
+	PendingDamage.Empty();
+	PendingDamageIndices.Empty();
+	Super::Deinitialize();
+}
+
+void UDamageAggregationSubsystem::Tick(float DeltaTime)
+{
+	Flush();
+}
+
+bool UDamageAggregationSubsystem::IsTickable() const
+{
+	return !PendingDamage.IsEmpty();
+}
+
+TStatId UDamageAggregationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageAggregationSubsystem, STATGROUP_Tickables);
+}
+
+void UDamageAggregationSubsystem::QueueDamage(AActor* Target, float Damage, TSubclassOf<UDamageType> DamageType,
+                                              AController* Instigator, AActor* DamageCauser, int32 HitCount)
+{
+	FPendingDamage& Pending = FindOrAddPendingDamage(Target, DamageType, Instigator, DamageCauser, false);
+	Pending.Damage += Damage;
+	Pending.HitCount += HitCount;
+}
+
+void UDamageAggregationSubsystem::QueueRadialDamage(AActor* Target, float Damage, TSubclassOf<UDamageType> DamageType,
+                                                    AController* Instigator, AActor* DamageCauser,
+                                                    const FVector& Origin, const FRadialDamageParams& Params)
+{
+	FPendingDamage& Pending = FindOrAddPendingDamage(Target, DamageType, Instigator, DamageCauser, true);
+	if (Pending.HitCount == 0 || Damage > Pending.StrongestRadialDamage)
+	{
+		Pending.StrongestRadialDamage = Damage;
+		Pending.Origin = Origin;
+		Pending.Params = Params;
+	}
+	Pending.Damage += Damage;
+	++Pending.HitCount;
+}
+
+void UDamageAggregationSubsystem::Flush()
+{
+	if (PendingDamage.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_DamageAggregation);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Damage Aggregation Flush", WeaponSystemChannel);
+
+	// TakeDamage could queue more damage, it will be applied by the next Flush
+	TArray<FPendingDamage> DamageToApply = MoveTemp(PendingDamage);
+	PendingDamageIndices.Reset();
+
+	for (const FPendingDamage& Pending : DamageToApply)
+	{
+		// Damage dealt to a previous target could have destroyed this one
+		if (AActor* Target = Pending.Target.Get())
+		{
+			if (Pending.IsRadial)
+			{
+				const FAggregatedRadialDamageEvent DamageEvent{
+					Pending.DamageType, Pending.HitCount, Pending.Origin, Pending.Params
+				};
+				Target->TakeDamage(Pending.Damage, DamageEvent, Pending.Instigator.Get(), Pending.DamageCauser.Get());
+			}
+			else
+			{
+				const FAggregatedDamageEvent DamageEvent{Pending.DamageType, Pending.HitCount};
+				Target->TakeDamage(Pending.Damage, DamageEvent, Pending.Instigator.Get(), Pending.DamageCauser.Get());
+			}
+		}
+	}
+
+	// Hand the storage back, so the queue doesn't reallocate every frame
+	if (PendingDamage.IsEmpty())
+	{
+		DamageToApply.Reset();
+		PendingDamage = MoveTemp(DamageToApply);
+	}
+}
+
+int32 UDamageAggregationSubsystem::Num() const
+{
+	return PendingDamage.Num();
+}
+
+UDamageAggregationSubsystem::FPendingDamage& UDamageAggregationSubsystem::FindOrAddPendingDamage(
+	AActor* Target, TSubclassOf<UDamageType> DamageType, AController* Instigator, AActor* DamageCauser, bool IsRadial)
+{
+	check(Target);
+	const FPendingDamageKey Key{Target, Instigator, DamageType.Get(), IsRadial};
+	if (const int32* Index = PendingDamageIndices.Find(Key))
+	{
+		return PendingDamage[*Index];
+	}
+	PendingDamageIndices.Add(Key, PendingDamage.Num());
+	FPendingDamage& Pending = PendingDamage.AddDefaulted_GetRef();
+	Pending.Target = Target;
+	Pending.Instigator = Instigator;
+	Pending.DamageCauser = DamageCauser;
+	Pending.DamageType = DamageType;
+	Pending.IsRadial = IsRadial;
+	return Pending;
+}
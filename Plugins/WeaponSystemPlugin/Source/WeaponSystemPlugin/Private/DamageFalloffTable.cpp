@@ -0,0 +1,60 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "DamageFalloffTable.h"
+
+#include "LogWeaponSystem.h"
+
+#include "Logging/StructuredLog.h"
+
+static TAutoConsoleVariable CVarDamageFalloffValidationTolerance(
+	TEXT("WeaponSystem.DamageFalloff.ValidationTolerance"),
+	0.f,
+	TEXT("Maximum error allowed between a baked damage falloff table and its curve, 0 to skip the validation."),
+	ECVF_Default);
+
+void FDamageFalloffTable::Bake(const FScalableFloat& Curve, float InMaxDistance, int32 NumSamples)
+{
+	check(InMaxDistance > 0);
+	NumSamples = FMath::Max(NumSamples, 2);
+	MaxDistance = InMaxDistance;
+	LastSegmentEnd = static_cast<float>(NumSamples - 1);
+	InvDistanceStep = LastSegmentEnd / MaxDistance;
+
+	Samples.SetNumUninitialized(NumSamples);
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		Samples[Index] = Curve.GetValueAtLevel(Index * MaxDistance / LastSegmentEnd);
+	}
+
+	if (const float Tolerance = CVarDamageFalloffValidationTolerance.GetValueOnGameThread(); Tolerance > 0)
+	{
+		const float MaxError = CalculateMaxError(Curve, NumSamples * 8);
+		if (MaxError > Tolerance)
+		{
+			UE_LOGFMT(LogWeaponSystem, Warning,
+			          "Damage falloff of `{Curve}` baked with {Samples} samples is off by up to {Error}, more samples are needed.",
+			          Curve.Curve.RowName, NumSamples, MaxError);
+		}
+	}
+}
+
+void FDamageFalloffTable::Reset()
+{
+	Samples.Empty();
+	InvDistanceStep = 0;
+	LastSegmentEnd = 0;
+	MaxDistance = 0;
+}
+
+float FDamageFalloffTable::CalculateMaxError(const FScalableFloat& Curve, int32 NumTestPoints) const
+{
+	check(IsBaked());
+	NumTestPoints = FMath::Max(NumTestPoints, 2);
+	float MaxError = 0;
+	for (int32 Index = 0; Index < NumTestPoints; ++Index)
+	{
+		const float Distance = Index * MaxDistance / (NumTestPoints - 1);
+		MaxError = FMath::Max(MaxError, FMath::Abs(Evaluate(Distance) - Curve.GetValueAtLevel(Distance)));
+	}
+	return MaxError;
+}
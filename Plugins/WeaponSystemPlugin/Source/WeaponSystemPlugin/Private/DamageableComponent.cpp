@@ -0,0 +1,20 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "DamageableComponent.h"
+
+#include "DamageableSpatialHashSubsystem.h"
+
+void UDamageableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>()->Register(GetOwner());
+}
+
+void UDamageableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetSubsystem<UDamageableSpatialHashSubsystem>()->Unregister(GetOwner());
+	}
+	Super::EndPlay(EndPlayReason);
+}
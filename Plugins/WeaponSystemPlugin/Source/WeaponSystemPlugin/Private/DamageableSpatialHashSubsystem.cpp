@@ -0,0 +1,221 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "DamageableSpatialHashSubsystem.h"
+
+#include "WeaponSystemTrace.h"
+
+#include "Async/ParallelFor.h"
+
+#include "GameFramework/Actor.h"
+
+static TAutoConsoleVariable CVarDamageableSpatialHashCellSize(
+	TEXT("WeaponSystem.SpatialHash.CellSize"),
+	1000.f,
+	TEXT("Size of the cells of the damageable Actors' spatial hash, read when a World is created."),
+	ECVF_Default);
+
+static TAutoConsoleVariable CVarDamageableSpatialHashParallelThreshold(
+	TEXT("WeaponSystem.SpatialHash.ParallelThreshold"),
+	64,
+	TEXT("Minimum amount of queries to run a batch with ParallelFor, 0 to always run them on the game thread."),
+	ECVF_Default);
+
+void UDamageableSpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	CellSize = FMath::Max(1.f, CVarDamageableSpatialHashCellSize.GetValueOnGameThread());
+}
+
+void UDamageableSpatialHashSubsystem::Deinitialize()
+{
+	Actors.Empty();
+	ActorKeys.Empty();
+	Locations.Empty();
+	CellKeys.Empty();
+	Cells.Empty();
+	ActorIndices.Empty();
+	Super::Deinitialize();
+}
+
+void UDamageableSpatialHashSubsystem::Tick(float DeltaTime)
+{
+	Update();
+}
+
+bool UDamageableSpatialHashSubsystem::IsTickable() const
+{
+	return !Actors.IsEmpty();
+}
+
+TStatId UDamageableSpatialHashSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageableSpatialHashSubsystem, STATGROUP_Tickables);
+}
+
+void UDamageableSpatialHashSubsystem::Register(AActor* Actor)
+{
+	check(Actor);
+	if (ActorIndices.Contains(Actor))
+	{
+		return;
+	}
+
+	const int32 Index = Actors.Add(Actor);
+	ActorKeys.Add(Actor);
+	Locations.Add(Actor->GetActorLocation());
+	CellKeys.Add(GetCellKey(Locations[Index]));
+	ActorIndices.Add(Actor, Index);
+	AddToCell(Index);
+	Actor->OnEndPlay.AddDynamic(this, &UDamageableSpatialHashSubsystem::HandleActorEndPlay);
+}
+
+void UDamageableSpatialHashSubsystem::Unregister(AActor* Actor)
+{
+	if (const int32* Index = ActorIndices.Find(Actor))
+	{
+		RemoveAt(*Index);
+		Actor->OnEndPlay.RemoveDynamic(this, &UDamageableSpatialHashSubsystem::HandleActorEndPlay);
+	}
+}
+
+void UDamageableSpatialHashSubsystem::Update()
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_SpatialHash);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Damageable Spatial Hash Update", WeaponSystemChannel);
+
+	// Backwards, the Actor swapped in by a removal has already been updated.
+	// Actors destroyed without EndPlay, or nulled by garbage collection, are dropped here.
+	for (int32 Index = Actors.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Actor = Actors[Index];
+		if (!IsValid(Actor))
+		{
+			RemoveAt(Index);
+			continue;
+		}
+
+		Locations[Index] = Actor->GetActorLocation();
+		const FIntVector CellKey = GetCellKey(Locations[Index]);
+		if (CellKey != CellKeys[Index])
+		{
+			RemoveFromCell(Index);
+			CellKeys[Index] = CellKey;
+			AddToCell(Index);
+		}
+	}
+}
+
+void UDamageableSpatialHashSubsystem::FindInRadius(const FVector& Location, float Radius, TArray<AActor*>& OutActors,
+                                                   const AActor* IgnoredActor) const
+{
+	ForEachWithinRadius(Location, Radius, [this, &OutActors, IgnoredActor](int32 Index, double)
+	{
+		if (Actors[Index] != IgnoredActor)
+		{
+			OutActors.Add(Actors[Index]);
+		}
+	});
+}
+
+AActor* UDamageableSpatialHashSubsystem::FindNearest(const FVector& Location, float MaxRadius,
+                                                     const AActor* IgnoredActor) const
+{
+	int32 NearestIndex = INDEX_NONE;
+	double NearestDistanceSquared = TNumericLimits<double>::Max();
+	ForEachWithinRadius(Location, MaxRadius,
+	                    [this, IgnoredActor, &NearestIndex, &NearestDistanceSquared](int32 Index, double DistanceSquared)
+	                    {
+		                    if (DistanceSquared < NearestDistanceSquared && Actors[Index] != IgnoredActor)
+		                    {
+			                    NearestIndex = Index;
+			                    NearestDistanceSquared = DistanceSquared;
+		                    }
+	                    });
+	return NearestIndex != INDEX_NONE ? Actors[NearestIndex].Get() : nullptr;
+}
+
+void UDamageableSpatialHashSubsystem::FindNearest(const FVector& Location, int32 K, float MaxRadius,
+                                                  TArray<AActor*>& OutActors, const AActor* IgnoredActor) const
+{
+	TArray<TPair<double, int32>, TInlineAllocator<32>> Candidates;
+	ForEachWithinRadius(Location, MaxRadius, [this, &Candidates, IgnoredActor](int32 Index, double DistanceSquared)
+	{
+		if (Actors[Index] != IgnoredActor)
+		{
+			Candidates.Emplace(DistanceSquared, Index);
+		}
+	});
+
+	Candidates.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key < B.Key; });
+	for (int32 Candidate = 0; Candidate < FMath::Min(K, Candidates.Num()); ++Candidate)
+	{
+		OutActors.Add(Actors[Candidates[Candidate].Value]);
+	}
+}
+
+void UDamageableSpatialHashSubsystem::FindNearestBatch(TConstArrayView<FVector> QueryLocations, float MaxRadius,
+                                                       TArrayView<AActor*> OutNearest) const
+{
+	check(QueryLocations.Num() == OutNearest.Num());
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Damageable Spatial Hash Nearest Batch", WeaponSystemChannel);
+
+	const int32 ParallelThreshold = CVarDamageableSpatialHashParallelThreshold.GetValueOnGameThread();
+	const EParallelForFlags Flags = ParallelThreshold > 0 && QueryLocations.Num() >= ParallelThreshold
+		                                ? EParallelForFlags::None
+		                                : EParallelForFlags::ForceSingleThread;
+	ParallelFor(QueryLocations.Num(), [this, QueryLocations, MaxRadius, OutNearest](int32 Query)
+	{
+		OutNearest[Query] = FindNearest(QueryLocations[Query], MaxRadius);
+	}, Flags);
+}
+
+int32 UDamageableSpatialHashSubsystem::Num() const
+{
+	return Actors.Num();
+}
+
+FIntVector UDamageableSpatialHashSubsystem::GetCellKey(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize),
+	                  FMath::FloorToInt32(Location.Y / CellSize),
+	                  FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void UDamageableSpatialHashSubsystem::AddToCell(int32 Index)
+{
+	Cells.FindOrAdd(CellKeys[Index]).Add(Index);
+}
+
+void UDamageableSpatialHashSubsystem::RemoveFromCell(int32 Index)
+{
+	TArray<int32>& Cell = Cells.FindChecked(CellKeys[Index]);
+	Cell.RemoveSingleSwap(Index, false);
+	if (Cell.IsEmpty())
+	{
+		Cells.Remove(CellKeys[Index]);
+	}
+}
+
+void UDamageableSpatialHashSubsystem::RemoveAt(int32 Index)
+{
+	RemoveFromCell(Index);
+	ActorIndices.Remove(ActorKeys[Index]);
+
+	const int32 LastIndex = Actors.Num() - 1;
+	if (Index != LastIndex)
+	{
+		// The last Actor takes the place of the removed one, its cell has to point to the new index
+		TArray<int32>& LastCell = Cells.FindChecked(CellKeys[LastIndex]);
+		LastCell[LastCell.Find(LastIndex)] = Index;
+		ActorIndices[ActorKeys[LastIndex]] = Index;
+	}
+	Actors.RemoveAtSwap(Index, 1, false);
+	ActorKeys.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	CellKeys.RemoveAtSwap(Index, 1, false);
+}
+
+void UDamageableSpatialHashSubsystem::HandleActorEndPlay(AActor* Actor, EEndPlayReason::Type)
+{
+	Unregister(Actor);
+}
@@ -0,0 +1,198 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "HitScanBatchSubsystem.h"
+
+#include "BallisticWeaponComponent.h"
+#include "DamageAggregationSubsystem.h"
+#include "RewindHistorySubsystem.h"
+#include "WeaponSystemTrace.h"
+
+#include "Algo/StableSort.h"
+
+#include "Async/ParallelFor.h"
+
+#include "Engine/World.h"
+
+static TAutoConsoleVariable CVarHitScanBatchParallelThreshold(
+	TEXT("WeaponSystem.HitScanBatch.ParallelThreshold"),
+	32,
+	TEXT("Minimum amount of hit-scan shots to trace them with ParallelFor, 0 to always trace them on the game thread."),
+	ECVF_Default);
+
+void UHitScanBatchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	// Tickable objects, UWeaponSimulationSubsystem included, tick in no particular order among themselves:
+	// the end of the Actor tick is the first point where every shot of the frame has been fired
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ThisClass::OnWorldPostActorTick);
+}
+
+void UHitScanBatchSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	Requests.Empty();
+	ResolvingRequests.Empty();
+	Weapons.Empty();
+	Hits.Empty();
+	TraceOrder.Empty();
+	ResolutionOrder.Empty();
+	Super::Deinitialize();
+}
+
+void UHitScanBatchSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World == GetWorld())
+	{
+		Flush();
+	}
+}
+
+void UHitScanBatchSubsystem::Enqueue(UBallisticWeaponComponent* Weapon, const FBallisticWeaponShot& Shot)
+{
+	check(Weapon);
+	Requests.Add({
+		Weapon,
+		Shot.Timestamp,
+		Shot.Location,
+		Shot.Location + Shot.Direction * Weapon->AmmoType.MaximumDistance
+	});
+}
+
+void UHitScanBatchSubsystem::Flush()
+{
+	if (Requests.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_HitScanBatch);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Hit-Scan Batch", WeaponSystemChannel);
+
+	// Shots fired while resolving, by damage or listeners, go to the next batch
+	ResolvingRequests.Reset();
+	Swap(Requests, ResolvingRequests);
+	const int32 Count = ResolvingRequests.Num();
+	Weapons.SetNumUninitialized(Count, false);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Weapons[Index] = ResolvingRequests[Index].Weapon.Get();
+	}
+	if (Hits.Num() < Count)
+	{
+		Hits.SetNum(Count);
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Hit-Scan Batch Traces", WeaponSystemChannel);
+		// The shots of a weapon rewinding its targets are traced together, under a single rewind to where they were
+		// RewindLatency seconds before this frame. The other shots are traced first, without rewinding anything.
+		const auto GetRewindingWeapon = [this](int32 Index) -> const UBallisticWeaponComponent*
+		{
+			const UBallisticWeaponComponent* Weapon = Weapons[Index];
+			return Weapon && Weapon->UseServerRewind && Weapon->RewindLatency > 0 ? Weapon : nullptr;
+		};
+		TraceOrder.SetNumUninitialized(Count, false);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			TraceOrder[Index] = Index;
+		}
+		Algo::StableSortBy(TraceOrder, [&](int32 Index) { return reinterpret_cast<UPTRINT>(GetRewindingWeapon(Index)); });
+
+		const UWorld* World = GetWorld();
+		URewindHistorySubsystem* History = World->GetSubsystem<URewindHistorySubsystem>();
+		for (int32 First = 0; First < Count;)
+		{
+			const UBallisticWeaponComponent* RewindingWeapon = GetRewindingWeapon(TraceOrder[First]);
+			int32 Last = First + 1;
+			while (Last < Count && GetRewindingWeapon(TraceOrder[Last]) == RewindingWeapon)
+			{
+				++Last;
+			}
+
+			TOptional<FRewindHistoryScope> Rewind;
+			if (RewindingWeapon)
+			{
+				// Actors out of range of every shot can't be hit, so they aren't moved
+				FBox Starts(ForceInit);
+				for (int32 Index = First; Index < Last; ++Index)
+				{
+					Starts += ResolvingRequests[TraceOrder[Index]].Start;
+				}
+				Rewind.Emplace(History, World->GetTimeSeconds() - RewindingWeapon->RewindLatency,
+				               RewindingWeapon->GetOwner(),
+				               FSphere(Starts.GetCenter(), Starts.GetExtent().Size() + RewindingWeapon->AmmoType.MaximumDistance));
+			}
+			TraceRequests(MakeArrayView(TraceOrder).Slice(First, Last - First));
+			First = Last;
+		}
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Hit-Scan Batch Resolution", WeaponSystemChannel);
+		ResolutionOrder.SetNumUninitialized(Count, false);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			ResolutionOrder[Index] = Index;
+		}
+		Algo::StableSortBy(ResolutionOrder, [this](int32 Index) { return ResolvingRequests[Index].Timestamp; });
+
+		// The pellets of a shot share Weapon and Timestamp and stay next to each other after the stable sort,
+		// their damage is applied once the whole shot has been resolved
+		UBallisticWeaponComponent* PendingWeapon = nullptr;
+		double PendingTimestamp = 0;
+		for (const int32 Index : ResolutionOrder)
+		{
+			// Damage could have destroyed a Weapon's owner
+			UBallisticWeaponComponent* Weapon = ResolvingRequests[Index].Weapon.Get();
+			if (PendingWeapon && (PendingWeapon != Weapon || PendingTimestamp != ResolvingRequests[Index].Timestamp))
+			{
+				PendingWeapon->ApplyPendingHitScanDamage();
+				// Reports the hits to the native listeners
+				PendingWeapon->NotifyStatusUpdate();
+				PendingWeapon = nullptr;
+			}
+			if (Weapon && !Hits[Index].IsEmpty())
+			{
+				Weapon->ResolveHitScanHits(Hits[Index]);
+				PendingWeapon = Weapon;
+				PendingTimestamp = ResolvingRequests[Index].Timestamp;
+			}
+		}
+		if (PendingWeapon)
+		{
+			PendingWeapon->ApplyPendingHitScanDamage();
+			PendingWeapon->NotifyStatusUpdate();
+		}
+	}
+
+	// The subsystem could have already ticked this frame, the damage just aggregated shouldn't wait for the next one
+	if (UDamageAggregationSubsystem* DamageAggregation = GetWorld()->GetSubsystem<UDamageAggregationSubsystem>())
+	{
+		DamageAggregation->Flush();
+	}
+}
+
+void UHitScanBatchSubsystem::TraceRequests(TConstArrayView<int32> Indices)
+{
+	// Scene queries only read the physics scene, the game thread is blocked until all of them are completed.
+	const UWorld* World = GetWorld();
+	const int32 ParallelThreshold = CVarHitScanBatchParallelThreshold.GetValueOnGameThread();
+	const EParallelForFlags Flags = ParallelThreshold > 0 && Indices.Num() >= ParallelThreshold
+		                                ? EParallelForFlags::None
+		                                : EParallelForFlags::ForceSingleThread;
+	ParallelFor(Indices.Num(), [this, World, Indices](int32 Order)
+	{
+		const int32 Index = Indices[Order];
+		Hits[Index].Reset();
+		if (const UBallisticWeaponComponent* Weapon = Weapons[Index])
+		{
+			const FRequest& Request = ResolvingRequests[Index];
+			Weapon->TraceHitScan(World, Request.Start, Request.End, Hits[Index]);
+		}
+	}, Flags);
+}
+
+int32 UHitScanBatchSubsystem::Num() const
+{
+	return Requests.Num();
+}
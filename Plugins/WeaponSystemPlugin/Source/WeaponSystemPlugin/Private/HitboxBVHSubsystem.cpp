@@ -0,0 +1,456 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "HitboxBVHSubsystem.h"
+
+#include "WeaponSystemTrace.h"
+
+#include "Components/PrimitiveComponent.h"
+
+#include "GameFramework/Actor.h"
+
+namespace
+{
+	constexpr int32 MaxShapesPerLeaf = 4;
+
+	double IntersectSphere(const FVector& Center, double Radius, const FVector& Origin, const FVector& Direction,
+	                       FVector& OutNormal)
+	{
+		const FVector ToOrigin = Origin - Center;
+		const double B = ToOrigin | Direction;
+		const double C = ToOrigin.SizeSquared() - Radius * Radius;
+		const double Discriminant = B * B - C;
+		if (Discriminant < 0 || (C > 0 && B > 0))
+		{
+			return -1;
+		}
+		const double Distance = -B - FMath::Sqrt(Discriminant);
+		OutNormal = (ToOrigin + Direction * Distance).GetSafeNormal();
+		return Distance;
+	}
+
+	bool IntersectBounds(const FVector& Min, const FVector& Max, const FVector& Origin, const FVector& InverseDirection,
+	                     double MaxDistance, double& OutDistance)
+	{
+		const FVector T1 = (Min - Origin) * InverseDirection;
+		const FVector T2 = (Max - Origin) * InverseDirection;
+		const double Enter = FMath::Max3(FMath::Min(T1.X, T2.X), FMath::Min(T1.Y, T2.Y), FMath::Min(T1.Z, T2.Z));
+		const double Exit = FMath::Min3(FMath::Max(T1.X, T2.X), FMath::Max(T1.Y, T2.Y), FMath::Max(T1.Z, T2.Z));
+		OutDistance = Enter;
+		return Enter <= Exit && Exit >= 0 && Enter <= MaxDistance;
+	}
+}
+
+void UHitboxBVHSubsystem::Deinitialize()
+{
+	Components.Empty();
+	ComponentOwners.Empty();
+	ComponentPrimitives.Empty();
+	ShapeTypes.Empty();
+	ShapeCenters.Empty();
+	ShapeRotations.Empty();
+	ShapeSizes.Empty();
+	ShapeMins.Empty();
+	ShapeMaxs.Empty();
+	ShapeComponents.Empty();
+	ShapeBones.Empty();
+	ShapeOrder.Empty();
+	Nodes.Empty();
+	OwnerOffsets.Empty();
+	Super::Deinitialize();
+}
+
+void UHitboxBVHSubsystem::Tick(float DeltaTime)
+{
+	Refresh();
+}
+
+bool UHitboxBVHSubsystem::IsTickable() const
+{
+	return !Components.IsEmpty();
+}
+
+TStatId UHitboxBVHSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHitboxBVHSubsystem, STATGROUP_Tickables);
+}
+
+void UHitboxBVHSubsystem::Register(UHitboxComponent* Component)
+{
+	check(Component);
+	Components.AddUnique(Component);
+}
+
+void UHitboxBVHSubsystem::Unregister(UHitboxComponent* Component)
+{
+	// Its hitboxes stay in the hierarchy until the next Refresh, but they can't be hit anymore
+	const int32 Index = Components.Find(Component);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+	Components[Index] = nullptr;
+	if (ComponentOwners.IsValidIndex(Index))
+	{
+		ComponentOwners[Index] = nullptr;
+		ComponentPrimitives[Index] = nullptr;
+	}
+}
+
+void UHitboxBVHSubsystem::SetOwnerOffset(const AActor* Owner, const FTransform& Offset)
+{
+	OwnerOffsets.Add(Owner, Offset);
+}
+
+void UHitboxBVHSubsystem::ResetOwnerOffsets()
+{
+	OwnerOffsets.Reset();
+}
+
+bool UHitboxBVHSubsystem::HasOwnerOffsets() const
+{
+	return !OwnerOffsets.IsEmpty();
+}
+
+void UHitboxBVHSubsystem::Refresh()
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_HitboxBVH);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Hitbox BVH Refresh", WeaponSystemChannel);
+
+	Components.RemoveAllSwap([](const UHitboxComponent* Component) { return !IsValid(Component); }, false);
+	ComponentOwners.Reset();
+	ComponentPrimitives.Reset();
+	ShapeTypes.Reset();
+	ShapeCenters.Reset();
+	ShapeRotations.Reset();
+	ShapeSizes.Reset();
+	ShapeMins.Reset();
+	ShapeMaxs.Reset();
+	ShapeComponents.Reset();
+	ShapeBones.Reset();
+
+	for (int32 ComponentIndex = 0; ComponentIndex < Components.Num(); ++ComponentIndex)
+	{
+		const UHitboxComponent* Component = Components[ComponentIndex];
+		USceneComponent* Source = Component->SourceComponent;
+		ComponentOwners.Add(Source ? Component->GetOwner() : nullptr);
+		ComponentPrimitives.Add(Cast<UPrimitiveComponent>(Source));
+		if (!Source)
+		{
+			continue;
+		}
+
+		for (const FHitboxShape& Shape : Component->Shapes)
+		{
+			const FTransform BoneTransform = Source->GetSocketTransform(Shape.BoneName);
+			const FQuat Rotation = BoneTransform.GetRotation() * Shape.Rotation.Quaternion();
+			const FVector Center = BoneTransform.GetLocation() + BoneTransform.GetRotation().RotateVector(Shape.Offset);
+
+			FVector Size;
+			FBox Bounds;
+			switch (Shape.Type)
+			{
+			case EHitboxShapeType::Sphere:
+				Size = FVector(Shape.Radius, 0, 0);
+				Bounds = FBox(Center - FVector(Shape.Radius), Center + FVector(Shape.Radius));
+				break;
+			case EHitboxShapeType::Capsule:
+				{
+					Size = FVector(Shape.Radius, 0, FMath::Max(0.f, Shape.HalfHeight - Shape.Radius));
+					const FVector Axis = Rotation.GetUpVector() * Size.Z;
+					Bounds = FBox(ForceInit);
+					Bounds += Center - Axis;
+					Bounds += Center + Axis;
+					Bounds = Bounds.ExpandBy(Shape.Radius);
+					break;
+				}
+			default:
+				Size = Shape.BoxExtent;
+				Bounds = FBox(-Size, Size).TransformBy(FTransform(Rotation, Center));
+				break;
+			}
+
+			ShapeTypes.Add(Shape.Type);
+			ShapeCenters.Add(Center);
+			ShapeRotations.Add(Rotation);
+			ShapeSizes.Add(Size);
+			ShapeMins.Add(Bounds.Min);
+			ShapeMaxs.Add(Bounds.Max);
+			ShapeComponents.Add(ComponentIndex);
+			ShapeBones.Add(Shape.BoneName);
+		}
+	}
+
+	ShapeOrder.SetNumUninitialized(ShapeTypes.Num(), false);
+	for (int32 Shape = 0; Shape < ShapeOrder.Num(); ++Shape)
+	{
+		ShapeOrder[Shape] = Shape;
+	}
+	Nodes.Reset();
+	if (!ShapeOrder.IsEmpty())
+	{
+		BuildNode(0, ShapeOrder.Num());
+	}
+}
+
+int32 UHitboxBVHSubsystem::BuildNode(int32 First, int32 Count)
+{
+	FVector Min(TNumericLimits<double>::Max());
+	FVector Max(TNumericLimits<double>::Lowest());
+	FVector CentroidMin = Min;
+	FVector CentroidMax = Max;
+	for (int32 Index = First; Index < First + Count; ++Index)
+	{
+		const int32 Shape = ShapeOrder[Index];
+		Min = Min.ComponentMin(ShapeMins[Shape]);
+		Max = Max.ComponentMax(ShapeMaxs[Shape]);
+		const FVector Centroid = (ShapeMins[Shape] + ShapeMaxs[Shape]) * 0.5;
+		CentroidMin = CentroidMin.ComponentMin(Centroid);
+		CentroidMax = CentroidMax.ComponentMax(Centroid);
+	}
+
+	const int32 NodeIndex = Nodes.Add({Min, Max, First, Count, INDEX_NONE});
+	if (Count <= MaxShapesPerLeaf)
+	{
+		return NodeIndex;
+	}
+
+	// Median split along the axis where the shapes are spread the most
+	const FVector Spread = CentroidMax - CentroidMin;
+	const int32 Axis = Spread.X >= Spread.Y && Spread.X >= Spread.Z ? 0 : (Spread.Y >= Spread.Z ? 1 : 2);
+	MakeArrayView(ShapeOrder.GetData() + First, Count).Sort([this, Axis](int32 A, int32 B)
+	{
+		return ShapeMins[A][Axis] + ShapeMaxs[A][Axis] < ShapeMins[B][Axis] + ShapeMaxs[B][Axis];
+	});
+
+	const int32 LeftCount = Count / 2;
+	Nodes[NodeIndex].Count = 0;
+	BuildNode(First, LeftCount);
+	const int32 RightChild = BuildNode(First + LeftCount, Count - LeftCount);
+	Nodes[NodeIndex].RightChild = RightChild;
+	return NodeIndex;
+}
+
+bool UHitboxBVHSubsystem::Raycast(const FVector& Start, const FVector& End, FHitResult& OutHit,
+                                  const AActor* IgnoredActor) const
+{
+	return Raycast(Start, End, OutHit, MakeArrayView(&IgnoredActor, 1));
+}
+
+bool UHitboxBVHSubsystem::Raycast(const FVector& Start, const FVector& End, FHitResult& OutHit,
+                                  TConstArrayView<const AActor*> IgnoredActors) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Hitbox BVH Raycast", WeaponSystemChannel);
+
+	const FVector Delta = End - Start;
+	const double Length = Delta.Size();
+	if (Nodes.IsEmpty() || Length <= UE_KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+	const FVector Direction = Delta / Length;
+
+	double NearestDistance = Length;
+	FVector NearestNormal = FVector::ZeroVector;
+	int32 NearestShape = RaycastShapes(Start, Direction, IgnoredActors, nullptr, NearestDistance, NearestNormal);
+
+	// The hitboxes of an offset owner are where the hierarchy has been built,
+	// so the ray is moved into that space instead, rigid offsets keep the distance along it
+	for (const TPair<const AActor*, FTransform>& OwnerOffset : OwnerOffsets)
+	{
+		if (IgnoredActors.Contains(OwnerOffset.Key))
+		{
+			continue;
+		}
+		const FTransform& Offset = OwnerOffset.Value;
+		FVector Normal;
+		const int32 Shape = RaycastShapes(Offset.InverseTransformPositionNoScale(Start),
+		                                  Offset.InverseTransformVectorNoScale(Direction), IgnoredActors,
+		                                  OwnerOffset.Key, NearestDistance, Normal);
+		if (Shape != INDEX_NONE)
+		{
+			NearestShape = Shape;
+			NearestNormal = Offset.TransformVectorNoScale(Normal);
+		}
+	}
+
+	if (NearestShape == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int32 Component = ShapeComponents[NearestShape];
+	OutHit = FHitResult(Start, End);
+	OutHit.bBlockingHit = true;
+	OutHit.Distance = NearestDistance;
+	OutHit.Time = NearestDistance / Length;
+	OutHit.Location = OutHit.ImpactPoint = Start + Direction * NearestDistance;
+	OutHit.Normal = OutHit.ImpactNormal = NearestNormal;
+	OutHit.BoneName = ShapeBones[NearestShape];
+	OutHit.Item = NearestShape;
+	OutHit.HitObjectHandle = FActorInstanceHandle(const_cast<AActor*>(ComponentOwners[Component]));
+	OutHit.Component = ComponentPrimitives[Component];
+	return true;
+}
+
+int32 UHitboxBVHSubsystem::RaycastShapes(const FVector& Origin, const FVector& Direction,
+                                         TConstArrayView<const AActor*> IgnoredActors, const AActor* OffsetOwner,
+                                         double& InOutNearestDistance, FVector& OutNormal) const
+{
+	const FVector InverseDirection(1.0 / Direction.X, 1.0 / Direction.Y, 1.0 / Direction.Z);
+	int32 NearestShape = INDEX_NONE;
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (!Stack.IsEmpty())
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		double EnterDistance;
+		if (!IntersectBounds(Node.Min, Node.Max, Origin, InverseDirection, InOutNearestDistance, EnterDistance))
+		{
+			continue;
+		}
+
+		if (Node.Count == 0)
+		{
+			Stack.Add(Node.RightChild);
+			Stack.Add(static_cast<int32>(&Node - Nodes.GetData()) + 1);
+			continue;
+		}
+
+		for (int32 Index = Node.First; Index < Node.First + Node.Count; ++Index)
+		{
+			const int32 Shape = ShapeOrder[Index];
+			const AActor* Owner = ComponentOwners[ShapeComponents[Shape]];
+			if (!Owner || IgnoredActors.Contains(Owner))
+			{
+				continue;
+			}
+			// Without an OffsetOwner only the owners that haven't been offset are where the hierarchy says
+			if (OffsetOwner ? Owner != OffsetOwner : (!OwnerOffsets.IsEmpty() && OwnerOffsets.Contains(Owner)))
+			{
+				continue;
+			}
+			FVector Normal;
+			const double Distance = IntersectShape(Shape, Origin, Direction, InOutNearestDistance, Normal);
+			if (Distance >= 0 && Distance <= InOutNearestDistance)
+			{
+				NearestShape = Shape;
+				InOutNearestDistance = Distance;
+				OutNormal = Normal;
+			}
+		}
+	}
+	return NearestShape;
+}
+
+int32 UHitboxBVHSubsystem::Num() const
+{
+	return ShapeTypes.Num();
+}
+
+double UHitboxBVHSubsystem::IntersectShape(int32 Shape, const FVector& Origin, const FVector& Direction,
+                                           double MaxDistance, FVector& OutNormal) const
+{
+	const FVector& Center = ShapeCenters[Shape];
+	const FVector& Size = ShapeSizes[Shape];
+	double Distance = -1;
+
+	switch (ShapeTypes[Shape])
+	{
+	case EHitboxShapeType::Sphere:
+		Distance = IntersectSphere(Center, Size.X, Origin, Direction, OutNormal);
+		break;
+	case EHitboxShapeType::Capsule:
+		{
+			// The cylinder between the caps first, then the two spheres of the caps
+			const FVector Axis = ShapeRotations[Shape].GetUpVector();
+			const FVector Bottom = Center - Axis * Size.Z;
+			const FVector ToOrigin = Origin - Bottom;
+			const double SegmentLength = 2 * Size.Z;
+			const double AxisDotDirection = Axis | Direction;
+			const double AxisDotOrigin = Axis | ToOrigin;
+			const double A = 1 - AxisDotDirection * AxisDotDirection;
+			if (A > UE_KINDA_SMALL_NUMBER)
+			{
+				const double B = (ToOrigin | Direction) - AxisDotOrigin * AxisDotDirection;
+				const double C = ToOrigin.SizeSquared() - AxisDotOrigin * AxisDotOrigin - Size.X * Size.X;
+				const double Discriminant = B * B - A * C;
+				if (Discriminant >= 0)
+				{
+					const double CylinderDistance = (-B - FMath::Sqrt(Discriminant)) / A;
+					const double Height = AxisDotOrigin + CylinderDistance * AxisDotDirection;
+					if (CylinderDistance >= 0 && Height >= 0 && Height <= SegmentLength)
+					{
+						Distance = CylinderDistance;
+						OutNormal = (ToOrigin + Direction * CylinderDistance - Axis * Height).GetSafeNormal();
+					}
+				}
+			}
+			FVector CapNormal;
+			for (const FVector& Cap : {Bottom, Center + Axis * Size.Z})
+			{
+				const double CapDistance = IntersectSphere(Cap, Size.X, Origin, Direction, CapNormal);
+				if (CapDistance >= 0 && (Distance < 0 || CapDistance < Distance))
+				{
+					Distance = CapDistance;
+					OutNormal = CapNormal;
+				}
+			}
+			break;
+		}
+	default:
+		{
+			// Slabs in the box space
+			const FQuat& Rotation = ShapeRotations[Shape];
+			const FVector LocalOrigin = Rotation.UnrotateVector(Origin - Center);
+			const FVector LocalDirection = Rotation.UnrotateVector(Direction);
+			double Enter = 0;
+			double Exit = MaxDistance;
+			FVector LocalNormal = -LocalDirection;
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				if (FMath::Abs(LocalDirection[Axis]) <= UE_SMALL_NUMBER)
+				{
+					if (FMath::Abs(LocalOrigin[Axis]) > Size[Axis])
+					{
+						return -1;
+					}
+					continue;
+				}
+				const double Inverse = 1.0 / LocalDirection[Axis];
+				const double Near = (-FMath::Sign(LocalDirection[Axis]) * Size[Axis] - LocalOrigin[Axis]) * Inverse;
+				const double Far = (FMath::Sign(LocalDirection[Axis]) * Size[Axis] - LocalOrigin[Axis]) * Inverse;
+				if (Near > Enter)
+				{
+					Enter = Near;
+					LocalNormal = FVector::ZeroVector;
+					LocalNormal[Axis] = -FMath::Sign(LocalDirection[Axis]);
+				}
+				Exit = FMath::Min(Exit, Far);
+				if (Enter > Exit)
+				{
+					return -1;
+				}
+			}
+			Distance = Enter;
+			OutNormal = Rotation.RotateVector(LocalNormal);
+			break;
+		}
+	}
+
+	// Starting inside a sphere or a capsule yields a negative distance, the hit is at the start like physics traces
+	if (Distance < 0 && ShapeTypes[Shape] != EHitboxShapeType::Box)
+	{
+		const FVector Closest = ShapeTypes[Shape] == EHitboxShapeType::Sphere
+			                        ? Center
+			                        : FMath::ClosestPointOnSegment(Origin,
+			                                                       Center - ShapeRotations[Shape].GetUpVector() * Size.Z,
+			                                                       Center + ShapeRotations[Shape].GetUpVector() * Size.Z);
+		if (FVector::DistSquared(Origin, Closest) <= Size.X * Size.X)
+		{
+			OutNormal = -Direction;
+			return 0;
+		}
+	}
+	return Distance <= MaxDistance ? Distance : -1;
+}
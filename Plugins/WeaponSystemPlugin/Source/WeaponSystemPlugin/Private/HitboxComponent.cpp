@@ -0,0 +1,32 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "HitboxComponent.h"
+
+#include "HitboxBVHSubsystem.h"
+
+#include "Components/SkinnedMeshComponent.h"
+
+#include "GameFramework/Actor.h"
+
+void UHitboxComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	if (!SourceComponent)
+	{
+		SourceComponent = GetOwner()->FindComponentByClass<USkinnedMeshComponent>();
+	}
+	if (!SourceComponent)
+	{
+		SourceComponent = GetOwner()->GetRootComponent();
+	}
+	GetWorld()->GetSubsystem<UHitboxBVHSubsystem>()->Register(this);
+}
+
+void UHitboxComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetSubsystem<UHitboxBVHSubsystem>()->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
@@ -2,10 +2,17 @@
 
 #include "ProjectileBase.h"
 
+#include "Curves/RealCurve.h"
+#include "Engine/CurveTable.h"
 #include "Engine/DamageEvents.h"
 
-#include "ActorPoolSubsystem.h"
+#include "DamageableSpatialHashSubsystem.h"
+#include "DamageAggregationSubsystem.h"
 #include "LogWeaponSystem.h"
+#include "ProjectileVisualsSubsystem.h"
+#include "RadialDamageBatchSubsystem.h"
+#include "TypedActorPool.h"
+#include "WeaponSystemTrace.h"
 
 #include "Logging/StructuredLog.h"
 
@@ -33,47 +40,152 @@ void AProjectileBase::BeginPlay()
 {
 	InitialSpeed = ProjectileMovementComponent->InitialSpeed;
 	IsActorHiddenAtBeginPlay = IsHidden();
+	BakeDamageFalloff();
+	if (UseInstancedVisuals)
+	{
+		// Hidden primitives don't get a scene proxy, the instance drawn by UProjectileVisualsSubsystem replaces it
+		ProjectileMeshComponent->SetVisibility(false);
+	}
+	if (UseSweptCollision)
+	{
+		ProjectileMeshComponent->SetGenerateOverlapEvents(false);
+		// The sweep covers the path just flown, so the movement has to happen first
+		AddTickPrerequisiteComponent(ProjectileMovementComponent);
+	}
+	else
+	{
+		// Bound for the whole lifetime, overlaps while in the pool are filtered out by IsInFlight
+		OnActorBeginOverlap.AddDynamic(this, &AProjectileBase::HandleActorBeginOverlap);
+	}
+	ProjectileMovementComponent->bIsHomingProjectile = UseHoming;
 	AcquiredFromPool(GetActorTransform(), GetOwner());
 	Super::BeginPlay();
 }
 
-void AProjectileBase::AcquiredFromPool(const FTransform& NewTransform, AActor* NewOwner)
+void AProjectileBase::Tick(float DeltaSeconds)
 {
-	if (EnableSpawnOffsetToAvoidWeaponCollision)
+	Super::Tick(DeltaSeconds);
+	if (UseSweptCollision && IsInFlight)
 	{
-		const double Offset = ProjectileMeshComponent->Bounds.SphereRadius + 1.f;
-		const FVector InitialLocation = NewTransform.GetLocation();
-		const FVector NewLocation = InitialLocation + NewTransform.GetRotation().GetForwardVector() * Offset;
+		SweepSinceLastTick(DeltaSeconds);
+	}
+	if (ProximityFuseRadius > 0 && IsInFlight && CheckProximityFuse())
+	{
+		return;
+	}
+	if (UseHoming && IsInFlight)
+	{
+		UpdateHomingTarget(DeltaSeconds);
+	}
+}
 
-		FTransform TransformWithOffset = NewTransform;
-		TransformWithOffset.SetLocation(NewLocation);
-		SetActorTransform(TransformWithOffset, false, nullptr, ETeleportType::TeleportPhysics);
+void AProjectileBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (VisualInstanceIndex != INDEX_NONE)
+	{
+		GetWorld()->GetSubsystem<UProjectileVisualsSubsystem>()->Unregister(this);
 	}
-	else
+	Super::EndPlay(EndPlayReason);
+}
+
+void AProjectileBase::AcquiredFromPool(const FTransform& NewTransform, AActor* NewOwner)
+{
+	FVector Location = NewTransform.GetLocation();
+	const FQuat Rotation = NewTransform.GetRotation();
+	if (EnableSpawnOffsetToAvoidWeaponCollision)
 	{
-		SetActorTransform(NewTransform, false, nullptr, ETeleportType::TeleportPhysics);
+		Location += Rotation.GetForwardVector() * (ProjectileMeshComponent->Bounds.SphereRadius + 1.f);
 	}
+	// Projectiles keep their scale, only location and rotation have to change
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
 
 	SetOwner(NewOwner);
-	SpawnLocation = GetActorLocation();
-	OnActorBeginOverlap.AddDynamic(this, &AProjectileBase::OnActorOverlap);
-	SetActorEnableCollision(true);
-	SetActorHiddenInGame(IsActorHiddenAtBeginPlay);
+	SpawnLocation = Location;
+
+	// The movement has been paused while in the pool, it's resumed as it is.
+	// It's rebuilt only if the projectile stopped on its own, ie. after bouncing to a halt.
 	if (ProjectileMovementComponent->HasStoppedSimulation())
 	{
-		const FVector Velocity = GetActorForwardVector() * InitialSpeed;
-		ProjectileMovementComponent->Velocity = ProjectileMovementComponent->ComputeVelocity(Velocity, 0);
 		ProjectileMovementComponent->SetUpdatedComponent(RootComponent);
-		ProjectileMovementComponent->SetActive(true);
 	}
+	if (ProjectileMovementComponent->Velocity.IsZero())
+	{
+		const FVector Velocity = Rotation.GetForwardVector() * InitialSpeed;
+		ProjectileMovementComponent->Velocity = ProjectileMovementComponent->ComputeVelocity(Velocity, 0);
+	}
+	TraveledDistance = 0;
+	PreviousSweepLocation = SpawnLocation;
+	PreviousSweepVelocity = ProjectileMovementComponent->Velocity;
+	SweptActorsHit.Reset();
+	HomingRetargetCountdown = 0;
+
+	SetInFlight(true);
 }
 
 void AProjectileBase::ReleasedToPool()
 {
-	ProjectileMovementComponent->StopSimulating({});
-	SetActorEnableCollision(false);
-	SetActorHiddenInGame(true);
-	OnActorBeginOverlap.RemoveDynamic(this, &AProjectileBase::OnActorOverlap);
+	ProjectileMovementComponent->Velocity = FVector::ZeroVector;
+	ProjectileMovementComponent->HomingTargetComponent = nullptr;
+	SetInFlight(false);
+}
+
+void AProjectileBase::SetInFlight(bool NewInFlight)
+{
+	if (IsInFlight == NewInFlight)
+	{
+		return;
+	}
+
+	// Every state that differs between a pooled projectile and a flying one, flipped in one go
+	IsInFlight = NewInFlight;
+	ProjectileMovementComponent->SetComponentTickEnabled(NewInFlight);
+	SetActorTickEnabled(NewInFlight);
+	SetActorEnableCollision(NewInFlight);
+	SetActorHiddenInGame(!NewInFlight || IsActorHiddenAtBeginPlay);
+
+	if (NewInFlight && UseInstancedVisuals && !IsActorHiddenAtBeginPlay)
+	{
+		GetWorld()->GetSubsystem<UProjectileVisualsSubsystem>()->Register(this);
+	}
+	else if (!NewInFlight && VisualInstanceIndex != INDEX_NONE)
+	{
+		GetWorld()->GetSubsystem<UProjectileVisualsSubsystem>()->Unregister(this);
+	}
+}
+
+void AProjectileBase::HandleActorBeginOverlap(AActor* OverlappedActor, AActor* OtherActor)
+{
+	if (IsInFlight)
+	{
+		OnActorOverlap(OverlappedActor, OtherActor);
+	}
+}
+
+bool AProjectileBase::CanBeSimulatedWithoutActor() const
+{
+	return !UseHoming && ProximityFuseRadius <= 0;
+}
+
+void AProjectileBase::BakeDamageFalloff() const
+{
+	AProjectileBase* Defaults = GetClass()->GetDefaultObject<AProjectileBase>();
+	if (Defaults->DamageFalloffSamples <= 0 || Defaults->DamageFalloff.IsBaked())
+	{
+		return;
+	}
+
+	// Past its last key the curve keeps the last value, like the table does past its last sample.
+	// Without a curve the damage is constant, evaluating it is already cheap.
+	const FRealCurve* Curve = Defaults->Damage.Curve.GetCurve(TEXT("AProjectileBase::BakeDamageFalloff"), false);
+	if (Curve && Curve->GetNumKeys() > 0)
+	{
+		float FirstKeyDistance, LastKeyDistance;
+		Curve->GetTimeRange(FirstKeyDistance, LastKeyDistance);
+		if (LastKeyDistance > 0)
+		{
+			Defaults->DamageFalloff.Bake(Defaults->Damage, LastKeyDistance, Defaults->DamageFalloffSamples);
+		}
+	}
 }
 
 bool AProjectileBase::ShouldIgnoreHit(AActor* ActorHit) const
@@ -85,7 +197,10 @@ bool AProjectileBase::ShouldIgnoreHit(AActor* ActorHit) const
 
 float AProjectileBase::CalculateDamage_Implementation(double TotalTraveledDistance, AActor* ActorToDamage)
 {
-	return Damage.GetValueAtLevel(TotalTraveledDistance);
+	const FDamageFalloffTable& ClassDamageFalloff = GetClass()->GetDefaultObject<AProjectileBase>()->DamageFalloff;
+	return ClassDamageFalloff.IsBaked()
+		       ? ClassDamageFalloff.Evaluate(TotalTraveledDistance)
+		       : Damage.GetValueAtLevel(TotalTraveledDistance);
 }
 
 bool AProjectileBase::ShouldDestroyAfterOverlap_Implementation()
@@ -114,29 +229,199 @@ void AProjectileBase::OnActorOverlap_Implementation(AActor* OverlappedActor, AAc
 		return;
 	}
 
-	if (OtherActor->CanBeDamaged())
+	const double Distance = FVector::Distance(SpawnLocation, GetActorLocation());
+	DealImpactDamage(GetWorld(), OtherActor, GetActorLocation(), Distance, Owner);
+
+	if (ShouldDestroyAfterOverlap())
 	{
-		const FVector HitLocation = GetActorLocation();
-		const double Distance = FVector::Distance(SpawnLocation, HitLocation);
-		const float DamageValue = CalculateDamage(Distance, OtherActor);
+		TActorPool<AProjectileBase>(GetWorld(), GetClass()).Release(this);
+	}
+}
+
+void AProjectileBase::DealDamage(AActor* ActorToDamage, double TotalTraveledDistance, AActor* DamageOwner)
+{
+	const float DamageValue = CalculateDamage(TotalTraveledDistance, ActorToDamage);
 
 #if WITH_EDITOR
-		if (ShouldLogHits)
-		{
-			UE_LOGFMT(LogWeaponSystem, Display, "{Name} will be damaged by {Damage} HP. Traveled for {Distance} units.",
-			          OtherActor->GetName(),
-			          DamageValue,
-			          Distance
-			);
-		}
+	if (ShouldLogHits)
+	{
+		UE_LOGFMT(LogWeaponSystem, Display, "{Name} will be damaged by {Damage} HP. Traveled for {Distance} units.",
+		          ActorToDamage->GetName(),
+		          DamageValue,
+		          TotalTraveledDistance
+		);
+	}
 #endif
 
+	AController* Instigator = DamageOwner ? DamageOwner->GetInstigatorController() : nullptr;
+	if (UseDamageAggregation)
+	{
+		// Simulated rounds call this on the class defaults, which don't belong to any World
+		ActorToDamage->GetWorld()->GetSubsystem<UDamageAggregationSubsystem>()->QueueDamage(
+			ActorToDamage, DamageValue, DamageType, Instigator, DamageOwner);
+	}
+	else
+	{
 		const FDamageEvent DamageEvent{DamageType};
-		OtherActor->TakeDamage(DamageValue, DamageEvent, Owner->GetInstigatorController(), Owner);
+		ActorToDamage->TakeDamage(DamageValue, DamageEvent, Instigator, DamageOwner);
+	}
+}
+
+void AProjectileBase::DealImpactDamage(UWorld* World, AActor* ActorHit, const FVector& ImpactLocation,
+                                       double TotalTraveledDistance, AActor* DamageOwner)
+{
+	if (!UseRadialDamage)
+	{
+		if (ActorHit && ActorHit->CanBeDamaged())
+		{
+			DealDamage(ActorHit, TotalTraveledDistance, DamageOwner);
+		}
+		return;
 	}
 
+	FRadialDamageExplosion Explosion;
+	Explosion.Origin = ImpactLocation;
+	Explosion.BaseDamage = CalculateDamage(TotalTraveledDistance, nullptr);
+	Explosion.MinimumDamage = ExplosionMinimumDamage;
+	// Designer data isn't validated, the receivers of the radial event expect the inner radius within the outer one
+	Explosion.InnerRadius = FMath::Min(ExplosionInnerRadius, ExplosionOuterRadius);
+	Explosion.OuterRadius = ExplosionOuterRadius;
+	Explosion.DamageFalloff = ExplosionDamageFalloff;
+	Explosion.DamageType = DamageType;
+	Explosion.Instigator = DamageOwner ? DamageOwner->GetInstigatorController() : nullptr;
+	Explosion.DamageCauser = DamageOwner;
+	Explosion.TraceOcclusion = ExplosionTraceOcclusion;
+	Explosion.OcclusionChannel = ExplosionOcclusionChannel;
+	World->GetSubsystem<URadialDamageBatchSubsystem>()->QueueExplosion(Explosion);
+}
+
+void AProjectileBase::SweepSinceLastTick(float DeltaSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Projectile Sweep", WeaponSystemChannel);
+
+	const FVector Start = PreviousSweepLocation;
+	const FVector End = GetActorLocation();
+	const FVector StartVelocity = PreviousSweepVelocity;
+	PreviousSweepLocation = End;
+	PreviousSweepVelocity = ProjectileMovementComponent->Velocity;
+
+	const double Length = FVector::Distance(Start, End);
+	if (Length <= UE_KINDA_SMALL_NUMBER || DeltaSeconds <= 0)
+	{
+		return;
+	}
+
+	// The path is rebuilt from where the round was, how fast it went and where it is now,
+	// a straight one is swept at once, a curved one in chords
+	const FVector Acceleration = 2 * (End - Start - StartVelocity * DeltaSeconds) / FMath::Square(DeltaSeconds);
+	const int32 SubSteps = Acceleration.IsNearlyZero()
+		                       ? 1
+		                       : FMath::Clamp(FMath::CeilToInt32(Length / SweepSubStepLength), 1, MaxSweepSubSteps);
+
+	const UWorld* World = GetWorld();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponSystemProjectileSweep), false, GetOwner());
+	for (const TWeakObjectPtr<AActor>& ActorHit : SweptActorsHit)
+	{
+		QueryParams.AddIgnoredActor(ActorHit.Get());
+	}
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(SweepRadius);
+
+	FVector SubStepStart = Start;
+	for (int32 SubStep = 1; SubStep <= SubSteps; ++SubStep)
+	{
+		const double Time = DeltaSeconds * SubStep / SubSteps;
+		const FVector SubStepEnd = SubStep == SubSteps
+			                           ? End
+			                           : Start + StartVelocity * Time + 0.5 * Acceleration * FMath::Square(Time);
+
+		FHitResult Hit;
+		while (SweepRadius > 0
+			       ? World->SweepSingleByChannel(Hit, SubStepStart, SubStepEnd, FQuat::Identity, SweepCollisionChannel,
+			                                     Shape, QueryParams)
+			       : World->LineTraceSingleByChannel(Hit, SubStepStart, SubStepEnd, SweepCollisionChannel, QueryParams))
+		{
+			const double HitDistance = TraveledDistance + Hit.Distance;
+			if (HandleSweptHit(Hit, HitDistance))
+			{
+				return;
+			}
+			if (!Hit.GetActor())
+			{
+				// Nothing to go through, it would be hit again right away
+				return;
+			}
+			TraveledDistance = HitDistance;
+			SubStepStart = Hit.Location;
+			SweptActorsHit.Add(Hit.GetActor());
+			QueryParams.AddIgnoredActor(Hit.GetActor());
+		}
+
+		TraveledDistance += FVector::Distance(SubStepStart, SubStepEnd);
+		SubStepStart = SubStepEnd;
+	}
+}
+
+bool AProjectileBase::HandleSweptHit(const FHitResult& Hit, double Distance)
+{
+	LastSweptHit = Hit;
+	AActor* ActorHit = Hit.GetActor();
+
+#if WITH_EDITOR
+	if (ShouldLogHits)
+	{
+		UE_LOGFMT(LogWeaponSystem, Display, "{Name} hit!", GetNameSafe(ActorHit));
+	}
+
+	if (ShouldTraceLineEachHit)
+	{
+		DrawDebugLine(GetWorld(), SpawnLocation, Hit.Location,
+		              FColor::Red, false, 1.f, 0, 0.5f);
+	}
+#endif
+
+	DealImpactDamage(GetWorld(), ActorHit, Hit.Location, Distance, Owner);
+
 	if (ShouldDestroyAfterOverlap())
 	{
-		UActorPoolSubsystem::DestroyOrReleaseToPool(GetWorld(), this);
+		SetActorLocation(Hit.Location);
+		TActorPool<AProjectileBase>(GetWorld(), GetClass()).Release(this);
+		return true;
+	}
+	return false;
+}
+
+void AProjectileBase::UpdateHomingTarget(float DeltaSeconds)
+{
+	HomingRetargetCountdown -= DeltaSeconds;
+	if (HomingRetargetCountdown > 0)
+	{
+		return;
+	}
+	HomingRetargetCountdown = HomingRetargetInterval;
+
+	const AActor* Target = GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>()->FindNearest(
+		GetActorLocation(), HomingSearchRadius, GetOwner());
+	ProjectileMovementComponent->HomingTargetComponent = Target ? Target->GetRootComponent() : nullptr;
+}
+
+bool AProjectileBase::CheckProximityFuse()
+{
+	AActor* ActorInRange = GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>()->FindNearest(
+		GetActorLocation(), ProximityFuseRadius, GetOwner());
+	if (!ActorInRange)
+	{
+		return false;
 	}
+
+#if WITH_EDITOR
+	if (ShouldLogHits)
+	{
+		UE_LOGFMT(LogWeaponSystem, Display, "Proximity fuse triggered by {Name}!", ActorInRange->GetName());
+	}
+#endif
+
+	const double Distance = FVector::Distance(SpawnLocation, GetActorLocation());
+	DealImpactDamage(GetWorld(), ActorInRange, GetActorLocation(), Distance, Owner);
+	TActorPool<AProjectileBase>(GetWorld(), GetClass()).Release(this);
+	return true;
 }
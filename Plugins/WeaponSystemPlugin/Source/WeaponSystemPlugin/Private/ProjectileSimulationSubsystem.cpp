@@ -0,0 +1,182 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "ProjectileSimulationSubsystem.h"
+
+#include "ProjectileBase.h"
+#include "WeaponSystemTrace.h"
+
+#include "Async/ParallelFor.h"
+
+#include "Engine/World.h"
+
+static TAutoConsoleVariable CVarProjectileSimulationParallelThreshold(
+	TEXT("WeaponSystem.ProjectileSimulation.ParallelThreshold"),
+	256,
+	TEXT("Minimum amount of rounds in flight to sweep them with ParallelFor, 0 to always sweep them on the game thread."),
+	ECVF_Default);
+
+void UProjectileSimulationSubsystem::Deinitialize()
+{
+	Archetypes.Empty();
+	Owners.Empty();
+	Positions.Empty();
+	Velocities.Empty();
+	GravityZ.Empty();
+	DragCoefficients.Empty();
+	RemainingLifetimes.Empty();
+	TraveledDistances.Empty();
+	NewPositions.Empty();
+	IgnoredActors.Empty();
+	Hits.Empty();
+	HasHit.Empty();
+	FinishedRounds.Empty();
+	Super::Deinitialize();
+}
+
+void UProjectileSimulationSubsystem::Tick(float DeltaTime)
+{
+	Simulate(DeltaTime);
+}
+
+bool UProjectileSimulationSubsystem::IsTickable() const
+{
+	return !Archetypes.IsEmpty();
+}
+
+TStatId UProjectileSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSimulationSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileSimulationSubsystem::Launch(AProjectileBase* Archetype, const FVector& Location,
+                                            const FVector& Direction, AActor* Owner)
+{
+	check(Archetype);
+	checkf(Archetype->HasAnyFlags(RF_ClassDefaultObject), TEXT("Only class defaults can be simulated."));
+	Archetype->BakeDamageFalloff();
+
+	const UProjectileMovementComponent* Movement = Archetype->ProjectileMovementComponent;
+	Archetypes.Add(Archetype);
+	Owners.Add(Owner);
+	Positions.Add(Location);
+	Velocities.Add(Direction * Movement->InitialSpeed);
+	GravityZ.Add(GetWorld()->GetGravityZ() * Movement->ProjectileGravityScale);
+	DragCoefficients.Add(Archetype->SimulatedDragCoefficient);
+	RemainingLifetimes.Add(Archetype->SimulatedLifetime);
+	TraveledDistances.Add(0);
+}
+
+void UProjectileSimulationSubsystem::Simulate(float DeltaTime)
+{
+	const int32 Count = Archetypes.Num();
+	if (Count == 0 || DeltaTime <= 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_ProjectileSimulation);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Projectile Simulation Tick", WeaponSystemChannel);
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Projectile Simulation Integrate", WeaponSystemChannel);
+		// Semi-implicit Euler, branchless so the compiler can vectorize it
+		NewPositions.SetNumUninitialized(Count, false);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FVector& Velocity = Velocities[Index];
+			const FVector Drag = Velocity * (-DragCoefficients[Index] * Velocity.Size());
+			Velocity += (Drag + FVector(0, 0, GravityZ[Index])) * DeltaTime;
+			NewPositions[Index] = Positions[Index] + Velocity * DeltaTime;
+			RemainingLifetimes[Index] -= DeltaTime;
+		}
+	}
+
+	// Resolved on the game thread, weak pointers can't be used by the workers
+	IgnoredActors.SetNumUninitialized(Count, false);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		IgnoredActors[Index] = Owners[Index].Get();
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Projectile Simulation Sweep", WeaponSystemChannel);
+		Hits.SetNum(Count, false);
+		HasHit.SetNumUninitialized(Count, false);
+		const int32 ParallelThreshold = CVarProjectileSimulationParallelThreshold.GetValueOnGameThread();
+		const EParallelForFlags Flags = ParallelThreshold > 0 && Count >= ParallelThreshold
+			                                ? EParallelForFlags::None
+			                                : EParallelForFlags::ForceSingleThread;
+		const UWorld* World = GetWorld();
+		ParallelFor(Count, [this, World](int32 Index)
+		{
+			const AProjectileBase* Archetype = Archetypes[Index];
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponSystemProjectileSimulation), false,
+			                                  IgnoredActors[Index]);
+			FHitResult& Hit = Hits[Index];
+			HasHit[Index] = Archetype->SimulatedCollisionRadius > 0
+				                ? World->SweepSingleByChannel(Hit, Positions[Index], NewPositions[Index],
+				                                              FQuat::Identity, Archetype->SimulatedCollisionChannel,
+				                                              FCollisionShape::MakeSphere(
+					                                              Archetype->SimulatedCollisionRadius),
+				                                              QueryParams)
+				                : World->LineTraceSingleByChannel(Hit, Positions[Index], NewPositions[Index],
+				                                                  Archetype->SimulatedCollisionChannel, QueryParams);
+		}, Flags);
+	}
+
+	FinishedRounds.Reset();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (HasHit[Index])
+		{
+			TraveledDistances[Index] += Hits[Index].Distance;
+			Positions[Index] = Hits[Index].Location;
+			FinishedRounds.Add(Index);
+		}
+		else
+		{
+			TraveledDistances[Index] += FVector::Distance(Positions[Index], NewPositions[Index]);
+			Positions[Index] = NewPositions[Index];
+			if (RemainingLifetimes[Index] <= 0)
+			{
+				FinishedRounds.Add(Index);
+			}
+		}
+	}
+
+	for (const int32 Index : FinishedRounds)
+	{
+		if (!HasHit[Index])
+		{
+			continue;
+		}
+
+		const FHitResult& Hit = Hits[Index];
+		Archetypes[Index]->DealImpactDamage(GetWorld(), Hit.GetActor(), Hit.Location, TraveledDistances[Index],
+		                                    Owners[Index].Get());
+		OnHit.Broadcast({Archetypes[Index], Owners[Index], Hit, TraveledDistances[Index]});
+	}
+
+	// Backwards, so the rounds swapped in are never ones still to be removed
+	for (int32 Index = FinishedRounds.Num() - 1; Index >= 0; --Index)
+	{
+		RemoveRound(FinishedRounds[Index]);
+	}
+}
+
+int32 UProjectileSimulationSubsystem::Num() const
+{
+	return Archetypes.Num();
+}
+
+void UProjectileSimulationSubsystem::RemoveRound(int32 Index)
+{
+	Archetypes.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	GravityZ.RemoveAtSwap(Index, 1, false);
+	DragCoefficients.RemoveAtSwap(Index, 1, false);
+	RemainingLifetimes.RemoveAtSwap(Index, 1, false);
+	TraveledDistances.RemoveAtSwap(Index, 1, false);
+}
@@ -0,0 +1,141 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "ProjectileVisualsSubsystem.h"
+
+#include "ProjectileBase.h"
+#include "WeaponSystemTrace.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+
+void UProjectileVisualsSubsystem::Deinitialize()
+{
+	for (const TPair<TObjectPtr<UClass>, FProjectileInstancedVisuals>& Visuals : VisualsPerClass)
+	{
+		for (AProjectileBase* Projectile : Visuals.Value.Projectiles)
+		{
+			Projectile->VisualInstanceIndex = INDEX_NONE;
+		}
+		if (Visuals.Value.Component)
+		{
+			Visuals.Value.Component->DestroyComponent();
+		}
+	}
+	VisualsPerClass.Empty();
+	Transforms.Empty();
+	NewInstanceTransforms.Empty();
+	InstancesToRemove.Empty();
+	Super::Deinitialize();
+}
+
+void UProjectileVisualsSubsystem::Tick(float DeltaTime)
+{
+	UpdateInstances();
+}
+
+bool UProjectileVisualsSubsystem::IsTickable() const
+{
+	return !VisualsPerClass.IsEmpty();
+}
+
+TStatId UProjectileVisualsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileVisualsSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileVisualsSubsystem::UpdateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_ProjectileVisuals);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Projectile Visuals Update", WeaponSystemChannel);
+
+	for (TPair<TObjectPtr<UClass>, FProjectileInstancedVisuals>& Visuals : VisualsPerClass)
+	{
+		UInstancedStaticMeshComponent* Component = Visuals.Value.Component;
+		const TArray<TObjectPtr<AProjectileBase>>& Projectiles = Visuals.Value.Projectiles;
+
+		Transforms.SetNumUninitialized(Projectiles.Num(), false);
+		for (int32 Index = 0; Index < Projectiles.Num(); ++Index)
+		{
+			Transforms[Index] = Projectiles[Index]->GetActorTransform();
+		}
+
+		// Projectiles come and go every frame, only the tail of the instances is added or removed
+		const int32 InstanceCount = Component->GetInstanceCount();
+		if (InstanceCount > Projectiles.Num())
+		{
+			InstancesToRemove.Reset();
+			for (int32 Index = InstanceCount - 1; Index >= Projectiles.Num(); --Index)
+			{
+				InstancesToRemove.Add(Index);
+			}
+			Component->RemoveInstances(InstancesToRemove);
+		}
+		else if (InstanceCount < Projectiles.Num())
+		{
+			NewInstanceTransforms.Reset();
+			NewInstanceTransforms.Append(Transforms.GetData() + InstanceCount, Projectiles.Num() - InstanceCount);
+			Component->AddInstances(NewInstanceTransforms, false, true, false);
+		}
+
+		if (!Transforms.IsEmpty())
+		{
+			Component->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+		}
+	}
+}
+
+const UInstancedStaticMeshComponent* UProjectileVisualsSubsystem::GetInstancedMeshComponent(
+	TSubclassOf<AProjectileBase> ProjectileClass) const
+{
+	const FProjectileInstancedVisuals* Visuals = VisualsPerClass.Find(ProjectileClass.Get());
+	return Visuals ? Visuals->Component : nullptr;
+}
+
+int32 UProjectileVisualsSubsystem::Num() const
+{
+	int32 Count = 0;
+	for (const TPair<TObjectPtr<UClass>, FProjectileInstancedVisuals>& Visuals : VisualsPerClass)
+	{
+		Count += Visuals.Value.Projectiles.Num();
+	}
+	return Count;
+}
+
+void UProjectileVisualsSubsystem::Register(AProjectileBase* Projectile)
+{
+	check(Projectile);
+	check(Projectile->VisualInstanceIndex == INDEX_NONE);
+
+	FProjectileInstancedVisuals& Visuals = VisualsPerClass.FindOrAdd(Projectile->GetClass());
+	if (!Visuals.Component)
+	{
+		// Same look as the projectiles' own mesh
+		const UStaticMeshComponent* Mesh = Projectile->ProjectileMeshComponent;
+		UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+		Component->SetMobility(EComponentMobility::Movable);
+		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Component->SetStaticMesh(Mesh->GetStaticMesh());
+		for (int32 Index = 0; Index < Mesh->GetNumMaterials(); ++Index)
+		{
+			Component->SetMaterial(Index, Mesh->GetMaterial(Index));
+		}
+		Component->RegisterComponentWithWorld(GetWorld());
+		Visuals.Component = Component;
+	}
+
+	Projectile->VisualInstanceIndex = Visuals.Projectiles.Add(Projectile);
+}
+
+void UProjectileVisualsSubsystem::Unregister(AProjectileBase* Projectile)
+{
+	check(Projectile);
+	const int32 Index = Projectile->VisualInstanceIndex;
+	check(Index != INDEX_NONE);
+
+	TArray<TObjectPtr<AProjectileBase>>& Projectiles = VisualsPerClass.FindChecked(Projectile->GetClass()).Projectiles;
+	Projectiles.RemoveAtSwap(Index, 1, false);
+	if (Projectiles.IsValidIndex(Index))
+	{
+		Projectiles[Index]->VisualInstanceIndex = Index;
+	}
+	Projectile->VisualInstanceIndex = INDEX_NONE;
+}
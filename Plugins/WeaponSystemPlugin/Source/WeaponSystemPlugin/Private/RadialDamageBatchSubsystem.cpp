@@ -0,0 +1,158 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "RadialDamageBatchSubsystem.h"
+
+#include "DamageableSpatialHashSubsystem.h"
+#include "DamageAggregationSubsystem.h"
+#include "WeaponSystemTrace.h"
+
+#include "Async/ParallelFor.h"
+
+#include "Engine/World.h"
+
+static TAutoConsoleVariable CVarRadialDamageParallelThreshold(
+	TEXT("WeaponSystem.RadialDamage.ParallelThreshold"),
+	32,
+	TEXT("Minimum amount of occlusion traces to run them with ParallelFor, 0 to always trace them on the game thread."),
+	ECVF_Default);
+
+float FRadialDamageExplosion::GetDamageAtDistance(float Distance) const
+{
+	if (Distance >= OuterRadius)
+	{
+		return 0;
+	}
+	if (Distance <= InnerRadius)
+	{
+		return BaseDamage;
+	}
+	const float Scale = FMath::Pow((OuterRadius - Distance) / (OuterRadius - InnerRadius), DamageFalloff);
+	return FMath::Lerp(MinimumDamage, BaseDamage, Scale);
+}
+
+void URadialDamageBatchSubsystem::Deinitialize()
+{
+	Explosions.Empty();
+	ResolvingExplosions.Empty();
+	DamageCausers.Empty();
+	PairExplosions.Empty();
+	PairTargets.Empty();
+	PairDistances.Empty();
+	PairDamages.Empty();
+	PairVisible.Empty();
+	TargetsInRange.Empty();
+	Super::Deinitialize();
+}
+
+void URadialDamageBatchSubsystem::Tick(float DeltaTime)
+{
+	Flush();
+}
+
+bool URadialDamageBatchSubsystem::IsTickable() const
+{
+	return !Explosions.IsEmpty();
+}
+
+TStatId URadialDamageBatchSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URadialDamageBatchSubsystem, STATGROUP_Tickables);
+}
+
+void URadialDamageBatchSubsystem::QueueExplosion(const FRadialDamageExplosion& Explosion)
+{
+	Explosions.Add(Explosion);
+}
+
+void URadialDamageBatchSubsystem::Flush()
+{
+	if (Explosions.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_RadialDamage);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Radial Damage Batch", WeaponSystemChannel);
+
+	ResolvingExplosions.Reset();
+	Swap(Explosions, ResolvingExplosions);
+	const TArray<FRadialDamageExplosion>& Batch = ResolvingExplosions;
+	DamageCausers.SetNumUninitialized(Batch.Num(), false);
+
+	PairExplosions.Reset();
+	PairTargets.Reset();
+	PairDistances.Reset();
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Radial Damage Broad Phase", WeaponSystemChannel);
+		const UDamageableSpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<UDamageableSpatialHashSubsystem>();
+		for (int32 Explosion = 0; Explosion < Batch.Num(); ++Explosion)
+		{
+			const FVector& Origin = Batch[Explosion].Origin;
+			DamageCausers[Explosion] = Batch[Explosion].DamageCauser.Get();
+			TargetsInRange.Reset();
+			SpatialHash->FindInRadius(Origin, Batch[Explosion].OuterRadius, TargetsInRange);
+			for (AActor* Target : TargetsInRange)
+			{
+				if (Target->CanBeDamaged())
+				{
+					PairExplosions.Add(Explosion);
+					PairTargets.Add(Target);
+					PairDistances.Add(FVector::Distance(Origin, Target->GetActorLocation()));
+				}
+			}
+		}
+	}
+
+	const int32 Count = PairTargets.Num();
+	PairDamages.SetNumUninitialized(Count, false);
+	for (int32 Pair = 0; Pair < Count; ++Pair)
+	{
+		PairDamages[Pair] = Batch[PairExplosions[Pair]].GetDamageAtDistance(PairDistances[Pair]);
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Radial Damage Occlusion", WeaponSystemChannel);
+		// Scene queries only read the physics scene, the game thread is blocked until all of them are completed.
+		const UWorld* World = GetWorld();
+		const int32 ParallelThreshold = CVarRadialDamageParallelThreshold.GetValueOnGameThread();
+		const EParallelForFlags Flags = ParallelThreshold > 0 && Count >= ParallelThreshold
+			                                ? EParallelForFlags::None
+			                                : EParallelForFlags::ForceSingleThread;
+		PairVisible.SetNumUninitialized(Count, false);
+		ParallelFor(Count, [this, World](int32 Pair)
+		{
+			const FRadialDamageExplosion& Explosion = ResolvingExplosions[PairExplosions[Pair]];
+			if (PairDamages[Pair] <= 0 || !Explosion.TraceOcclusion)
+			{
+				PairVisible[Pair] = PairDamages[Pair] > 0;
+				return;
+			}
+
+			AActor* Target = PairTargets[Pair];
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponSystemRadialDamage), false, Target);
+			QueryParams.AddIgnoredActor(DamageCausers[PairExplosions[Pair]]);
+			PairVisible[Pair] = !World->LineTraceTestByChannel(Explosion.Origin, Target->GetActorLocation(),
+			                                                   Explosion.OcclusionChannel, QueryParams);
+		}, Flags);
+	}
+
+	UDamageAggregationSubsystem* DamageAggregation = GetWorld()->GetSubsystem<UDamageAggregationSubsystem>();
+	for (int32 Pair = 0; Pair < Count; ++Pair)
+	{
+		if (PairVisible[Pair])
+		{
+			const FRadialDamageExplosion& Explosion = Batch[PairExplosions[Pair]];
+			const FRadialDamageParams Params(Explosion.BaseDamage, Explosion.MinimumDamage, Explosion.InnerRadius,
+			                                 Explosion.OuterRadius, Explosion.DamageFalloff);
+			DamageAggregation->QueueRadialDamage(PairTargets[Pair], PairDamages[Pair], Explosion.DamageType,
+			                                     Explosion.Instigator.Get(), Explosion.DamageCauser.Get(),
+			                                     Explosion.Origin, Params);
+		}
+	}
+	DamageAggregation->Flush();
+}
+
+int32 URadialDamageBatchSubsystem::Num() const
+{
+	return Explosions.Num();
+}
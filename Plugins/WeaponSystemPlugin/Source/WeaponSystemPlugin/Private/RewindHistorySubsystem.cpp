@@ -0,0 +1,297 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "RewindHistorySubsystem.h"
+
+#include "HitboxBVHSubsystem.h"
+#include "WeaponSystemTrace.h"
+
+#include "Components/PrimitiveComponent.h"
+
+#include "GameFramework/Actor.h"
+
+static TAutoConsoleVariable CVarRewindHistorySize(
+	TEXT("WeaponSystem.Rewind.HistorySize"),
+	64,
+	TEXT("Transforms recorded for each rewindable Actor, read when a World is created."),
+	ECVF_Default);
+
+namespace
+{
+	// Bodies simulating physics aren't rewound, they would be teleported back with stale velocities
+	FBodyInstance* GetRewindableBody(UPrimitiveComponent* Primitive)
+	{
+		FBodyInstance* Body = Primitive->GetBodyInstance();
+		const bool IsRewindable = Primitive->Mobility == EComponentMobility::Movable
+			&& Primitive->IsQueryCollisionEnabled()
+			&& Body && Body->IsValidBodyInstance() && !Body->IsInstanceSimulatingPhysics();
+		return IsRewindable ? Body : nullptr;
+	}
+}
+
+void URewindHistorySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	HistorySize = FMath::Max(2, CVarRewindHistorySize.GetValueOnGameThread());
+}
+
+void URewindHistorySubsystem::Deinitialize()
+{
+	Actors.Empty();
+	Heads.Empty();
+	Counts.Empty();
+	Timestamps.Empty();
+	Locations.Empty();
+	Rotations.Empty();
+	RewoundActors.Empty();
+	UpdateMemoryStat();
+	Super::Deinitialize();
+}
+
+void URewindHistorySubsystem::Tick(float DeltaTime)
+{
+	Record(GetWorld()->GetTimeSeconds());
+}
+
+bool URewindHistorySubsystem::IsTickable() const
+{
+	return !Actors.IsEmpty();
+}
+
+TStatId URewindHistorySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URewindHistorySubsystem, STATGROUP_Tickables);
+}
+
+void URewindHistorySubsystem::Register(AActor* Actor)
+{
+	check(Actor);
+	checkf(!IsRewound, TEXT("Actors can't be registered while rewound."));
+	if (Actors.Contains(Actor))
+	{
+		return;
+	}
+
+	Actors.Add(Actor);
+	Heads.Add(0);
+	Counts.Add(0);
+	Timestamps.AddZeroed(HistorySize);
+	Locations.AddZeroed(HistorySize);
+	Rotations.AddZeroed(HistorySize);
+	RewoundActors.Add(false);
+	UpdateMemoryStat();
+}
+
+void URewindHistorySubsystem::Unregister(AActor* Actor)
+{
+	checkf(!IsRewound, TEXT("Actors can't be unregistered while rewound."));
+	const int32 Index = Actors.Find(Actor);
+	if (Index != INDEX_NONE)
+	{
+		RemoveAt(Index);
+	}
+}
+
+void URewindHistorySubsystem::Record(double Timestamp)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_RewindRecord);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Rewind History Record", WeaponSystemChannel);
+
+	for (int32 Index = Actors.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Actor = Actors[Index];
+		if (!IsValid(Actor))
+		{
+			// Garbage collection may have already nulled it, so it can't be searched
+			RemoveAt(Index);
+			continue;
+		}
+
+		const int32 Sample = Index * HistorySize + Heads[Index];
+		Timestamps[Sample] = Timestamp;
+		Locations[Sample] = Actor->GetActorLocation();
+		Rotations[Sample] = Actor->GetActorQuat();
+		Heads[Index] = (Heads[Index] + 1) % HistorySize;
+		Counts[Index] = FMath::Min(Counts[Index] + 1, HistorySize);
+	}
+}
+
+bool URewindHistorySubsystem::GetTransformAt(const AActor* Actor, double Timestamp, FTransform& OutTransform) const
+{
+	const int32 Index = Actors.Find(const_cast<AActor*>(Actor));
+	if (Index == INDEX_NONE || Counts[Index] == 0)
+	{
+		return false;
+	}
+	OutTransform = SampleAt(Index, Timestamp);
+	return true;
+}
+
+void URewindHistorySubsystem::RewindTo(double Timestamp, const AActor* IgnoredActor, const TOptional<FSphere>& Region)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Rewind History Rewind", WeaponSystemChannel);
+	checkf(!IsRewound, TEXT("Tried to rewind the Actors twice, Restore them first."));
+	IsRewound = true;
+
+	UHitboxBVHSubsystem* Hitboxes = GetWorld()->GetSubsystem<UHitboxBVHSubsystem>();
+	const bool HasHitboxes = Hitboxes && Hitboxes->Num() > 0;
+	for (int32 Index = 0; Index < Actors.Num(); ++Index)
+	{
+		AActor* Actor = Actors[Index];
+		RewoundActors[Index] = false;
+		if (Actor == IgnoredActor || !IsValid(Actor) || Counts[Index] == 0)
+		{
+			continue;
+		}
+
+		// Maps the world space as it is now to the one at Timestamp
+		const FTransform Now = Actor->GetActorTransform();
+		const FTransform Past = SampleAt(Index, Timestamp);
+		const FTransform Offset = Now.Inverse() * FTransform(Past.GetRotation(), Past.GetLocation(), Now.GetScale3D());
+		Actor->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent* Primitive)
+		{
+			if (Region && FVector::DistSquared(Offset.TransformPosition(Primitive->Bounds.Origin), Region->Center)
+				> FMath::Square(Region->W + Primitive->Bounds.SphereRadius))
+			{
+				return;
+			}
+			RewoundActors[Index] = true;
+
+			// Only the physics scene is moved, the component keeps its transform to be restored from
+			if (FBodyInstance* Body = GetRewindableBody(Primitive))
+			{
+				Body->SetBodyTransform(Primitive->GetComponentTransform() * Offset, ETeleportType::TeleportPhysics);
+			}
+		});
+
+		if (HasHitboxes && RewoundActors[Index])
+		{
+			Hitboxes->SetOwnerOffset(Actor, Offset);
+		}
+	}
+
+	// Raycasts move into the space of the offset owners, so the hierarchy isn't rebuilt
+	AreHitboxesRewound = HasHitboxes && Hitboxes->HasOwnerOffsets();
+}
+
+void URewindHistorySubsystem::Restore()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Rewind History Restore", WeaponSystemChannel);
+	checkf(IsRewound, TEXT("Tried to restore Actors that haven't been rewound."));
+	IsRewound = false;
+
+	for (int32 Index = 0; Index < Actors.Num(); ++Index)
+	{
+		if (!RewoundActors[Index] || !IsValid(Actors[Index]))
+		{
+			continue;
+		}
+		Actors[Index]->ForEachComponent<UPrimitiveComponent>(false, [](UPrimitiveComponent* Primitive)
+		{
+			if (FBodyInstance* Body = GetRewindableBody(Primitive))
+			{
+				Body->SetBodyTransform(Primitive->GetComponentTransform(), ETeleportType::TeleportPhysics);
+			}
+		});
+	}
+
+	if (AreHitboxesRewound)
+	{
+		AreHitboxesRewound = false;
+		GetWorld()->GetSubsystem<UHitboxBVHSubsystem>()->ResetOwnerOffsets();
+	}
+}
+
+bool URewindHistorySubsystem::IsRewinding() const
+{
+	return IsRewound;
+}
+
+int32 URewindHistorySubsystem::Num() const
+{
+	return Actors.Num();
+}
+
+SIZE_T URewindHistorySubsystem::GetBytesPerTrackedActor() const
+{
+	return HistorySize * (sizeof(double) + sizeof(FVector) + sizeof(FQuat))
+		+ sizeof(TObjectPtr<AActor>) + 2 * sizeof(int32) + sizeof(bool);
+}
+
+void URewindHistorySubsystem::RemoveAt(int32 Index)
+{
+	// The history of the last Actor takes the place of the removed one
+	const int32 LastIndex = Actors.Num() - 1;
+	if (Index != LastIndex)
+	{
+		const int32 To = Index * HistorySize;
+		const int32 From = LastIndex * HistorySize;
+		for (int32 Sample = 0; Sample < HistorySize; ++Sample)
+		{
+			Timestamps[To + Sample] = Timestamps[From + Sample];
+			Locations[To + Sample] = Locations[From + Sample];
+			Rotations[To + Sample] = Rotations[From + Sample];
+		}
+	}
+	Timestamps.SetNum(LastIndex * HistorySize, false);
+	Locations.SetNum(LastIndex * HistorySize, false);
+	Rotations.SetNum(LastIndex * HistorySize, false);
+	Actors.RemoveAtSwap(Index, 1, false);
+	Heads.RemoveAtSwap(Index, 1, false);
+	Counts.RemoveAtSwap(Index, 1, false);
+	RewoundActors.RemoveAtSwap(Index, 1, false);
+	UpdateMemoryStat();
+}
+
+int32 URewindHistorySubsystem::GetSampleIndex(int32 ActorIndex, int32 Sample) const
+{
+	// Sample 0 is the oldest one
+	const int32 Oldest = Heads[ActorIndex] - Counts[ActorIndex] + HistorySize;
+	return ActorIndex * HistorySize + (Oldest + Sample) % HistorySize;
+}
+
+FTransform URewindHistorySubsystem::SampleAt(int32 ActorIndex, double Timestamp) const
+{
+	const int32 Count = Counts[ActorIndex];
+	const int32 Oldest = GetSampleIndex(ActorIndex, 0);
+	const int32 Newest = GetSampleIndex(ActorIndex, Count - 1);
+	if (Timestamp <= Timestamps[Oldest])
+	{
+		return FTransform(Rotations[Oldest], Locations[Oldest]);
+	}
+	if (Timestamp >= Timestamps[Newest])
+	{
+		return FTransform(Rotations[Newest], Locations[Newest]);
+	}
+
+	// Timestamps grow from the oldest to the newest sample, the first one after Timestamp is searched in between
+	int32 Low = 0;
+	int32 High = Count - 1;
+	while (High - Low > 1)
+	{
+		const int32 Middle = (Low + High) / 2;
+		if (Timestamps[GetSampleIndex(ActorIndex, Middle)] <= Timestamp)
+		{
+			Low = Middle;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	const int32 Before = GetSampleIndex(ActorIndex, Low);
+	const int32 After = GetSampleIndex(ActorIndex, High);
+	if (Timestamps[After] <= Timestamps[Before])
+	{
+		return FTransform(Rotations[After], Locations[After]);
+	}
+	const double Alpha = (Timestamp - Timestamps[Before]) / (Timestamps[After] - Timestamps[Before]);
+	return FTransform(FQuat::Slerp(Rotations[Before], Rotations[After], Alpha),
+	                  FMath::Lerp(Locations[Before], Locations[After], Alpha));
+}
+
+void URewindHistorySubsystem::UpdateMemoryStat() const
+{
+	SET_MEMORY_STAT(STAT_WeaponSystem_RewindMemory, Actors.Num() * GetBytesPerTrackedActor());
+	SET_DWORD_STAT(STAT_WeaponSystem_RewindTrackedActors, Actors.Num());
+}
@@ -0,0 +1,119 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#include "WeaponSimulationSubsystem.h"
+
+#include "BallisticWeaponComponent.h"
+#include "WeaponSystemTrace.h"
+
+#include "Async/ParallelFor.h"
+
+static TAutoConsoleVariable CVarWeaponSimulationParallelThreshold(
+	TEXT("WeaponSystem.Simulation.ParallelThreshold"),
+	512,
+	TEXT("Minimum amount of firing weapons to run the decision pass with ParallelFor, 0 to always run it on the game thread."),
+	ECVF_Default);
+
+// Weapons handled by a single task of the decision pass
+static constexpr int32 WeaponsPerChunk = 128;
+
+void UWeaponSimulationSubsystem::Deinitialize()
+{
+	while (!Weapons.IsEmpty())
+	{
+		Unregister(Weapons.Last());
+	}
+	WeaponsToUpdatePerChunk.Empty();
+	WeaponsToUpdate.Empty();
+	Super::Deinitialize();
+}
+
+void UWeaponSimulationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponSystem_Simulation);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Weapon Simulation Tick", WeaponSystemChannel);
+
+	const double Now = GetWorld()->TimeSeconds;
+	const int32 Count = Weapons.Num();
+	const int32 ChunkCount = FMath::DivideAndRoundUp(Count, WeaponsPerChunk);
+	if (WeaponsToUpdatePerChunk.Num() < ChunkCount)
+	{
+		WeaponsToUpdatePerChunk.SetNum(ChunkCount);
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Weapon Simulation Decision Pass", WeaponSystemChannel);
+		const int32 ParallelThreshold = CVarWeaponSimulationParallelThreshold.GetValueOnGameThread();
+		const EParallelForFlags Flags = ParallelThreshold > 0 && Count >= ParallelThreshold
+			                                ? EParallelForFlags::None
+			                                : EParallelForFlags::ForceSingleThread;
+		ParallelFor(ChunkCount, [this, Now, Count](int32 Chunk)
+		{
+			TArray<UBallisticWeaponComponent*>& ChunkWeapons = WeaponsToUpdatePerChunk[Chunk];
+			ChunkWeapons.Reset();
+			const int32 End = FMath::Min((Chunk + 1) * WeaponsPerChunk, Count);
+			for (int32 Index = Chunk * WeaponsPerChunk; Index < End; ++Index)
+			{
+				if (Weapons[Index]->NeedsFiringUpdate(Now))
+				{
+					ChunkWeapons.Add(Weapons[Index]);
+				}
+			}
+		}, Flags);
+	}
+
+	// Weapons that stop firing unregister themselves, so the indices can't be used while updating them.
+	WeaponsToUpdate.Reset();
+	for (int32 Chunk = 0; Chunk < ChunkCount; ++Chunk)
+	{
+		WeaponsToUpdate.Append(WeaponsToUpdatePerChunk[Chunk]);
+	}
+
+	for (UBallisticWeaponComponent* Weapon : WeaponsToUpdate)
+	{
+		// The damage dealt by a previous Weapon could have destroyed this one, or its owner
+		if (!IsValid(Weapon) || Weapon->SimulationIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		Weapon->SimulateFiring();
+	}
+}
+
+bool UWeaponSimulationSubsystem::IsTickable() const
+{
+	return !Weapons.IsEmpty();
+}
+
+TStatId UWeaponSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponSimulationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UWeaponSimulationSubsystem::Num() const
+{
+	return Weapons.Num();
+}
+
+void UWeaponSimulationSubsystem::Register(UBallisticWeaponComponent* Weapon)
+{
+	check(Weapon);
+	checkf(Weapon->SimulationIndex == INDEX_NONE, TEXT("Weapon %s is already simulated."), *Weapon->GetName());
+
+	Weapon->SimulationIndex = Weapons.Add(Weapon);
+}
+
+void UWeaponSimulationSubsystem::Unregister(UBallisticWeaponComponent* Weapon)
+{
+	check(Weapon);
+	const int32 Index = Weapon->SimulationIndex;
+	checkf(Weapons.IsValidIndex(Index) && Weapons[Index] == Weapon, TEXT("Weapon %s isn't simulated."),
+	       *Weapon->GetName());
+
+	Weapons.RemoveAtSwap(Index, 1, false);
+	if (Weapons.IsValidIndex(Index))
+	{
+		Weapons[Index]->SimulationIndex = Index;
+	}
+	Weapon->SimulationIndex = INDEX_NONE;
+}
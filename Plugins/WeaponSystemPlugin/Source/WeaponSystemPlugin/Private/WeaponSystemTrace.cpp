@@ -6,3 +6,14 @@ DEFINE_STAT(STAT_WeaponSystem_Tick);
 DEFINE_STAT(STAT_WeaponSystem_Fire);
 DEFINE_STAT(STAT_WeaponSystem_Notify);
 DEFINE_STAT(STAT_WeaponSystem_UpdateMagazine);
+DEFINE_STAT(STAT_WeaponSystem_Simulation);
+DEFINE_STAT(STAT_WeaponSystem_HitScanBatch);
+DEFINE_STAT(STAT_WeaponSystem_DamageAggregation);
+DEFINE_STAT(STAT_WeaponSystem_ProjectileSimulation);
+DEFINE_STAT(STAT_WeaponSystem_ProjectileVisuals);
+DEFINE_STAT(STAT_WeaponSystem_SpatialHash);
+DEFINE_STAT(STAT_WeaponSystem_RadialDamage);
+DEFINE_STAT(STAT_WeaponSystem_HitboxBVH);
+DEFINE_STAT(STAT_WeaponSystem_RewindRecord);
+DEFINE_STAT(STAT_WeaponSystem_RewindTrackedActors);
+DEFINE_STAT(STAT_WeaponSystem_RewindMemory);
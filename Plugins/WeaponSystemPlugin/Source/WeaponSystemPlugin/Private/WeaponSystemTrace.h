@@ -10,3 +10,14 @@ DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick"), STAT_WeaponSystem_Tick, STATGROUP_Weapon
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Fire"), STAT_WeaponSystem_Fire, STATGROUP_WeaponSystem,);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Notify"), STAT_WeaponSystem_Notify, STATGROUP_WeaponSystem,);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Magazine"), STAT_WeaponSystem_UpdateMagazine, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulation"), STAT_WeaponSystem_Simulation, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hit-Scan Batch"), STAT_WeaponSystem_HitScanBatch, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Damage Aggregation"), STAT_WeaponSystem_DamageAggregation, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Simulation"), STAT_WeaponSystem_ProjectileSimulation, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile Visuals"), STAT_WeaponSystem_ProjectileVisuals, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Hash"), STAT_WeaponSystem_SpatialHash, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Radial Damage"), STAT_WeaponSystem_RadialDamage, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hitbox BVH"), STAT_WeaponSystem_HitboxBVH, STATGROUP_WeaponSystem,);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rewind Record"), STAT_WeaponSystem_RewindRecord, STATGROUP_WeaponSystem,);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Rewind Tracked Actors"), STAT_WeaponSystem_RewindTrackedActors, STATGROUP_WeaponSystem,);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Rewind History"), STAT_WeaponSystem_RewindMemory, STATGROUP_WeaponSystem,);
@@ -3,7 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DamageFalloffTable.h"
 #include "ProjectileBase.h"
+#include "Engine/HitResult.h"
 #include "ScalableFloat.h"
 #include "AmmoType.generated.h"
 
@@ -21,6 +23,13 @@ struct WEAPONSYSTEMPLUGIN_API FAmmoType
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ammunition", meta=(EditCondition="!IsHitScan"))
 	TSubclassOf<AProjectileBase> ProjectileClass;
 
+	// Only one round every N is a visible ProjectileClass Actor, the tracer.
+	// The others are virtual rounds flown by UProjectileSimulationSubsystem with ProjectileClass' Simulation settings:
+	// they deal the same damage, but stop at the first hit. Homing and proximity fuse rounds are always Actors.
+	// 1 spawns an Actor for every round.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ammunition", meta=(EditCondition="!IsHitScan", UIMin=1, ClampMin=1))
+	int TracerEveryNthRound = 1;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ammunition", meta=(EditCondition="IsHitScan"))
 	TEnumAsByte<ECollisionChannel> CollisionChannel = TEnumAsByte(ECC_Visibility);
 
@@ -33,4 +42,116 @@ struct WEAPONSYSTEMPLUGIN_API FAmmoType
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Damage",
 		meta=(EditCondition="IsHitScan", UIMin=1, ClampMin=1, Units="cm"))
 	float MaximumDistance = 100;
+
+	// The round follows a ballistic trajectory instead of a straight line, and damages its target after its flight time.
+	// No Actor is spawned: the trajectory is solved analytically and checked with BallisticTraceSegments traces.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ballistics", meta=(EditCondition="IsHitScan"))
+	bool UseBallisticTrajectory = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ballistics",
+		meta=(EditCondition="IsHitScan && UseBallisticTrajectory", UIMin=1, ClampMin=1, Units="cm/s"))
+	float MuzzleSpeed = 80000;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ballistics",
+		meta=(EditCondition="IsHitScan && UseBallisticTrajectory"))
+	float BallisticGravityScale = 1;
+
+	// Linear air drag, in 1/s. Linear, so the trajectory has a closed form.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ballistics",
+		meta=(EditCondition="IsHitScan && UseBallisticTrajectory", UIMin=0, ClampMin=0))
+	float BallisticDrag = 0;
+
+	// The round is traced for this long at most, or until it has flown for MaximumDistance.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ballistics",
+		meta=(EditCondition="IsHitScan && UseBallisticTrajectory", UIMin=0.01, ClampMin=0.01, Units="s"))
+	float MaxFlightTime = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ballistics",
+		meta=(EditCondition="IsHitScan && UseBallisticTrajectory", UIMin=1, ClampMin=1))
+	int BallisticTraceSegments = 8;
+
+	// Damage is baked into a lookup table with this many samples up to MaximumDistance. 0 evaluates the curve on every hit.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Damage", meta=(EditCondition="IsHitScan", UIMin=0, ClampMin=0))
+	int DamageFalloffSamples = 64;
+
+	// Each layer hit spends its penetration cost, the round stops once the budget is spent. 0 disables penetration.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Penetration", meta=(EditCondition="IsHitScan", UIMin=0, ClampMin=0))
+	float PenetrationBudget = 0;
+
+	// Bounds the cost of a single shot against dense geometry: at most MaxPenetratedLayers + 1 layers are resolved per round.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Penetration",
+		meta=(EditCondition="IsHitScan", UIMin=0, ClampMin=0))
+	int MaxPenetratedLayers = 4;
+
+	// Penetrating rounds are traced for PenetrationBudget times this distance, up to MaximumDistance.
+	// The single multi-hit trace of a shot never collects the geometry past it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Penetration",
+		meta=(EditCondition="IsHitScan", UIMin=1, ClampMin=1, Units="cm"))
+	float PenetrationRangePerBudget = 5000;
+
+	// Fraction of damage lost for each layer penetrated.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Penetration",
+		meta=(EditCondition="IsHitScan", UIMin=0, ClampMin=0, UIMax=1, ClampMax=1))
+	float DamageAttenuationPerLayer = 0.5f;
+
+	// Penetration cost of the surfaces that aren't listed in PenetrationCostPerSurface.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Penetration", meta=(EditCondition="IsHitScan", UIMin=0, ClampMin=0))
+	float DefaultPenetrationCost = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Penetration", meta=(EditCondition="IsHitScan"))
+	TMap<TEnumAsByte<EPhysicalSurface>, float> PenetrationCostPerSurface;
+
+	// Rounds fired by each shot, e.g. the pellets of a shotgun shell. Hit-scan damage is summed per target.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Spread", meta=(UIMin=1, ClampMin=1))
+	int PelletCount = 1;
+
+	// Half-angle of the cone the pellets are spread into.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Spread",
+		meta=(UIMin=0, ClampMin=0, UIMax=90, ClampMax=90, Units="deg"))
+	float SpreadHalfAngle = 0;
+
+	// Pellets follow the same evenly distributed pattern every shot instead of a random one.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Spread")
+	bool UseFixedSpreadPattern = false;
+
+	// Seed of the weapon's spread RNG, 0 picks a random one on BeginPlay.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Spread", meta=(EditCondition="!UseFixedSpreadPattern"))
+	int32 SpreadSeed = 0;
+
+	bool IsPenetrating() const;
+
+	// Traces a hit-scan round from Start to End, with one trace per shot. Can be called from any thread.
+	// Without penetration OutHits holds just the blocking hit,
+	// otherwise the blocking hits along the way, ordered by distance, up to where the budget or MaxPenetratedLayers stop the round.
+	bool Trace(const UWorld* World, const FVector& Start, const FVector& End, TArray<FHitResult>& OutHits) const;
+
+	// Where a penetrating round fired from Start towards End stops being traced, see PenetrationRangePerBudget.
+	FVector ClampPenetrationTraceEnd(const FVector& Start, const FVector& End) const;
+
+	float GetPenetrationCost(const FHitResult& Hit) const;
+
+	// Must be called again whenever Damage or MaximumDistance change.
+	void BakeDamageFalloff();
+
+	float GetDamageAtDistance(float Distance) const;
+
+	bool IsBallistic() const;
+
+	// Position of a ballistic round Time seconds after leaving Start with Velocity.
+	FVector GetBallisticPosition(const FVector& Start, const FVector& Velocity, const FVector& Gravity,
+	                             double Time) const;
+
+	// Traces the trajectory of a ballistic round fired from Start along Direction, one segment after the other.
+	// The path stops at MaximumDistance. OutHit.Distance is the length of the path flown up to the impact.
+	bool TraceBallistic(const UWorld* World, const FVector& Start, const FVector& Direction, FHitResult& OutHit,
+	                    double& OutFlightTime) const;
+
+	bool HasSpread() const;
+
+	// Fills OutDirections with the direction of each pellet, spread uniformly within the cone around Forward.
+	// Random numbers are drawn first, then every direction is computed in a single branchless pass.
+	void GeneratePelletDirections(const FVector& Forward, FRandomStream& Stream, TArrayView<FVector> OutDirections) const;
+
+private:
+	FDamageFalloffTable DamageFalloff;
 };
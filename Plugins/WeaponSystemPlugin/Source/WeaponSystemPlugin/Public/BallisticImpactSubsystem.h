@@ -0,0 +1,48 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BallisticImpactSubsystem.generated.h"
+
+class UBallisticWeaponComponent;
+
+/**
+ * Delays the damage of ballistic hit-scan rounds until they would have reached their target.
+ * Impacts are kept in a heap ordered by time, the subsystem only ticks while some are pending.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UBallisticImpactSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FImpact
+	{
+		TWeakObjectPtr<UBallisticWeaponComponent> Weapon;
+		double Timestamp;
+		FHitResult Hit;
+
+		bool operator<(const FImpact& Other) const
+		{
+			return Timestamp < Other.Timestamp;
+		}
+	};
+
+	TArray<FImpact> Impacts;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void Schedule(UBallisticWeaponComponent* Weapon, double ImpactTimestamp, const FHitResult& Hit);
+
+	// Applies the damage of every impact due by Timestamp.
+	void ApplyImpactsDueBy(double Timestamp);
+
+	int32 Num() const;
+};
@@ -5,9 +5,11 @@
 #include "CoreMinimal.h"
 #include "AmmoType.h"
 #include "Components/SceneComponent.h"
+#include "Engine/TimerHandle.h"
 #include "BallisticWeaponComponent.generated.h"
 
 class UArrowComponent;
+struct FRewindHistoryScope;
 
 UENUM(Blueprintable)
 enum class EBallisticWeaponStatus
@@ -18,7 +20,7 @@ enum class EBallisticWeaponStatus
 	Firing,
 	// We asked to reload, won't fire until Reload has been called.
 	WaitingReload,
-	// Tick: Will reload once the time has been passed
+	// Timer: Will reload once the time has been passed
 	Reloading,
 };
 
@@ -33,13 +35,58 @@ enum class EBallisticWeaponFiringStrategy : uint8
 	// Precise for fire-rates up to 1200 RPM
 	Timestamp,
 
-	// More precise for fire-rates over 1400 RPM
+	// Fires every shot due since the previous frame at its exact timestamp,
+	// interpolating the muzzle between the previous and current frame.
+	// Precise at any fire-rate and frame-rate.
 	TimestampWithAccumulator,
 
-	// EXPERIMENTAL, DO NOT USE
+	// Like TimestampWithAccumulator, but shots are scheduled on an integer nanosecond clock
+	// with exact rational intervals derived from the fire-rate, so it never drifts, even over hours.
 	TimestampIntegerBased,
 };
 
+// A single shot, with the muzzle at the time it has been fired.
+struct FBallisticWeaponShot
+{
+	double Timestamp;
+	FVector Location;
+	FVector Direction;
+};
+
+// Shots fired by a weapon since its previous notification.
+struct FBallisticWeaponShotBatch
+{
+	// When each shot has been fired, in World seconds.
+	TConstArrayView<double> Timestamps;
+	// What hit-scan and ballistic rounds have damaged. Batched hit-scan and ballistic rounds land after being fired,
+	// so their hits are reported by a later batch than their shots.
+	TConstArrayView<FHitResult> Hits;
+
+	int32 Num() const { return Timestamps.Num(); }
+};
+
+class UBallisticWeaponComponent;
+
+// Native counterpart of the weapon delegates, notified right after them without going through reflection.
+// Shots aren't collapsed: every shot fired since the previous notification is in the batch of OnShotsFired.
+// Listeners aren't owned by the weapon, they have to be removed before being destroyed.
+class IBallisticWeaponListener
+{
+public:
+	virtual ~IBallisticWeaponListener() = default;
+
+	virtual void OnStatusChanged(UBallisticWeaponComponent& Weapon, EBallisticWeaponStatus Status) {}
+	virtual void OnReloadRequested(UBallisticWeaponComponent& Weapon) {}
+	virtual void OnReloadStarted(UBallisticWeaponComponent& Weapon) {}
+	virtual void OnReloadCanceled(UBallisticWeaponComponent& Weapon) {}
+	virtual void OnReloadCompleted(UBallisticWeaponComponent& Weapon) {}
+	virtual void OnReloadFailed(UBallisticWeaponComponent& Weapon) {}
+	virtual void OnFiringStarted(UBallisticWeaponComponent& Weapon) {}
+	virtual void OnFiringStopped(UBallisticWeaponComponent& Weapon) {}
+	// Shots can be empty, if only the hits of rounds fired earlier have landed.
+	virtual void OnShotsFired(UBallisticWeaponComponent& Weapon, const FBallisticWeaponShotBatch& Shots) {}
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FWeaponComponentBasicDelegateSignature);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWeaponComponentNotifyStatusChangeSignature, EBallisticWeaponStatus, Status)
@@ -56,8 +103,10 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FWeaponComponentNotifyStatusChangeSi
  *		- A shot has been fired, so ammunition have been updated
  *		- Reloading requested/started/completed
  *		- Status changed
+ * - The same events for native listeners, see IBallisticWeaponListener
  * The orientation of this component is considered the Muzzle where the ammo will be fired from.
- * This component requires ticking to handle firing and reloading.
+ * This component ticks only while firing, reloading is driven by a timer,
+ * so an idle weapon has no per-frame cost.
  */
 UCLASS(ClassGroup=("Weapon Components"), meta=(BlueprintSpawnableComponent))
 class WEAPONSYSTEMPLUGIN_API UBallisticWeaponComponent : public USceneComponent
@@ -68,21 +117,22 @@ public:
 	UBallisticWeaponComponent();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 #pragma region Properties
 
 	// Never needs to reload, never consumes ammo.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetHasInfiniteAmmo, Category="Weapon")
 	bool HasInfiniteAmmo = false;
 
 	// Never consumes ammo, requires reloading each magazine
 	// WARNING: if AmmoUsedEachShot > CurrentMagazine, the weapon will not fire.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetHasInfiniteAmmoReserve, Category="Weapon")
 	bool HasInfiniteAmmoReserve = false;
 
 	// If true, reloading discards all the ammo left in the magazine,
 	// otherwise only the ammo necessary to fill it are taken from the reserve.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetReloadingDiscardsEntireMagazine, Category="Weapon")
 	bool ReloadingDiscardsEntireMagazine = false;
 
 	// How much ammo a magazine has.
@@ -112,7 +162,7 @@ public:
 	EBallisticWeaponFiringStrategy FiringStrategy = EBallisticWeaponFiringStrategy::Automatic;
 
 	// If the weapon shoots in burst fire mode.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetIsBurstFire, Category="Weapon")
 	bool IsBurstFire = false;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon",
@@ -122,8 +172,43 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon", meta=(UIMin=0, ClampMin=0, Units="s"))
 	float SecondsToReload = 0;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon")
-	FAmmoType AmmoType; // TODO: Handle penetration in hit-scan?
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetAmmoType, Category="Weapon")
+	FAmmoType AmmoType;
+
+	// While firing, let UWeaponSimulationSubsystem update this weapon instead of ticking it.
+	// Worth it when lots of weapons fire at once, ie. AI crowds. Must be set before BeginPlay.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Weapon|Performance")
+	bool UseSimulationSubsystem = false;
+
+	// Hit-scan shots are traced by UHitScanBatchSubsystem at the end of the frame, together with the other weapons' ones,
+	// instead of immediately.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetUseBatchedHitScan, Category="Weapon|Performance",
+		meta=(EditCondition="AmmoType.IsHitScan"))
+	bool UseBatchedHitScan = false;
+
+	// Hit-scan rounds are tested against the hitboxes of UHitboxBVHSubsystem, physics is traced only for the world
+	// geometry in front of them. Penetrating rounds go through each Actor's nearest hitbox as a layer.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetUseHitboxes, Category="Weapon|Performance",
+		meta=(EditCondition="AmmoType.IsHitScan"))
+	bool UseHitboxes = false;
+
+	// Hit-scan rounds are traced against the Actors tracked by URewindHistorySubsystem
+	// where they were RewindLatency seconds before the shot, hitboxes of UseHitboxes included.
+	// The shots fired during the same frame, or batched together, share a single rewind to the end of the frame.
+	// Ballistic and projectile rounds aren't rewound.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetUseServerRewind, Category="Weapon|Rewind",
+		meta=(EditCondition="AmmoType.IsHitScan"))
+	bool UseServerRewind = false;
+
+	// Latency of the shooter, usually updated from its ping by the server.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Weapon|Rewind",
+		meta=(EditCondition="AmmoType.IsHitScan && UseServerRewind", UIMin=0, ClampMin=0, Units="s"))
+	float RewindLatency = 0;
+
+	// Hit-scan damage goes through UDamageAggregationSubsystem, so each target is damaged once per frame.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetUseDamageAggregation, Category="Weapon|Performance",
+		meta=(EditCondition="AmmoType.IsHitScan"))
+	bool UseDamageAggregation = false;
 
 #pragma endregion
 
@@ -180,6 +265,10 @@ public:
 
 #pragma endregion
 
+	// Listener is notified after the delegates, until removed.
+	void AddListener(IBallisticWeaponListener* Listener);
+	void RemoveListener(IBallisticWeaponListener* Listener);
+
 	UFUNCTION(BlueprintCallable)
 	EBallisticWeaponStatus GetStatus() const;
 
@@ -221,21 +310,139 @@ public:
 	UFUNCTION(BlueprintCallable)
 	bool HasEnoughTimePassedFromLastShot() const;
 
+	// Also selects the fire policy again.
 	UFUNCTION(BlueprintCallable)
 	void SetFiringStrategy(EBallisticWeaponFiringStrategy NewStrategy);
 
+	// The setters of the settings the fire policy is specialized for select it again once playing.
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon")
+	void SetHasInfiniteAmmo(bool NewHasInfiniteAmmo);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon")
+	void SetHasInfiniteAmmoReserve(bool NewHasInfiniteAmmoReserve);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon")
+	void SetReloadingDiscardsEntireMagazine(bool NewReloadingDiscardsEntireMagazine);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon")
+	void SetIsBurstFire(bool NewIsBurstFire);
+
+	// Bakes its damage falloff too.
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon")
+	void SetAmmoType(const FAmmoType& NewAmmoType);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon|Performance")
+	void SetUseBatchedHitScan(bool NewUseBatchedHitScan);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon|Performance")
+	void SetUseHitboxes(bool NewUseHitboxes);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon|Rewind")
+	void SetUseServerRewind(bool NewUseServerRewind);
+
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category="Weapon|Performance")
+	void SetUseDamageAggregation(bool NewUseDamageAggregation);
+
+	// Picks the firing, round and reloading code specialized for the FiringStrategy, burst fire, ammo model,
+	// kind of rounds of the AmmoType and UseBatchedHitScan, so none of them is checked while firing.
+	// Called by BeginPlay and by the setters, call it again after assigning them from native code while playing:
+	// firing with a policy selected for other settings is caught by an ensure outside of shipping builds.
+	UFUNCTION(BlueprintCallable)
+	void SelectFirePolicy();
+
 protected:
-	void Fire();
+	FBallisticWeaponShot MakeShotFromMuzzle() const;
+	// First shot after pulling the trigger, restarts the shot schedule from now.
+	FBallisticWeaponShot StartFiringSequence();
+	using FWeaponPolicy = void (UBallisticWeaponComponent::*)();
+	using FFireRoundsPolicy = void (UBallisticWeaponComponent::*)(const FBallisticWeaponShot&);
+
+	FWeaponPolicy FireOncePolicy = nullptr;
+	FWeaponPolicy StartFiringPolicy = nullptr;
+	FWeaponPolicy SimulateFiringPolicy = nullptr;
+	FWeaponPolicy ReloadMagazinePolicy = nullptr;
+	FFireRoundsPolicy FireRoundsPolicy = nullptr;
+
+	template <EBallisticWeaponFiringStrategy Strategy>
+	void SelectTriggerPolicies();
+	// Automatic is resolved by BeginPlay, so it's never a policy
+	template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+	void FireOnceWith();
+	template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+	void StartFiringWith();
+	template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+	void SimulateFiringWith();
+	// Fires all the shots due since the last one.
+	template <EBallisticWeaponFiringStrategy Strategy, bool IsBurst, bool InfiniteAmmo>
+	void FireScheduledShots();
+	template <EBallisticWeaponFiringStrategy Strategy>
+	bool IsNextShotDue() const;
+	template <bool IsBurst>
+	void Fire(const FBallisticWeaponShot& Shot);
+	TArrayView<const FVector> MakePelletDirections(const FBallisticWeaponShot& Shot);
+#if WITH_EDITOR
+	void DrawPelletTraces(const FBallisticWeaponShot& Shot, TConstArrayView<FVector> PelletDirections) const;
+#endif
+	// Round policies, what each pellet of a shot does
+	void FireHitScanRounds(const FBallisticWeaponShot& Shot);
+	void FireBatchedHitScanRounds(const FBallisticWeaponShot& Shot);
+	void FireBallisticRounds(const FBallisticWeaponShot& Shot);
+	void FireProjectileRounds(const FBallisticWeaponShot& Shot);
+	// Rewinds the targets of the hit-scan rounds to Timestamp - RewindLatency until Rewind is reset, with UseServerRewind.
+	void RewindHitScanTargets(TOptional<FRewindHistoryScope>& Rewind, double Timestamp, const FSphere& Region);
+	// Set while the scheduled shots of a frame are fired against targets rewound once for all of them
+	bool IsFrameRewound = false;
+	// Traces a hit-scan round like FAmmoType::Trace, against the hitboxes too with UseHitboxes. Can be called from any thread.
+	bool TraceHitScan(const UWorld* World, const FVector& Start, const FVector& End, TArray<FHitResult>& OutHits) const;
+	// Adds the damage of a hit-scan round to the pending one, penetrating the hits as long as the AmmoType allows it.
+	void ResolveHitScanHits(TConstArrayView<FHitResult> Hits);
+	void AddHitScanDamage(const FHitResult& HitResult, float DamageMultiplier = 1.f);
+	// Deals the damage resolved since the last call, once per target, so every pellet of a shot hitting it is summed up.
+	void ApplyPendingHitScanDamage();
+
+	// Reused by every hit-scan shot traced by this weapon
+	TArray<FHitResult> HitScanHits;
+
+	struct FPendingHitScanDamage
+	{
+		TWeakObjectPtr<AActor> Actor;
+		float Damage;
+		// Pellets and penetrated layers that hit the Actor, forwarded to the damage aggregation
+		int32 HitCount;
+	};
+
+	TArray<FPendingHitScanDamage> PendingHitScanDamage;
+	// Where the damage of the shot being resolved starts, the one of the previous shots isn't summed to it
+	int32 FirstPendingHitScanDamageOfShot = 0;
+
+	FRandomStream SpreadStream;
+
+	// Projectile rounds fired since BeginPlay, to pick the tracers
+	int64 ProjectileRoundsFired;
+	template <bool InfiniteAmmo>
 	void UpdateMagazineAfterFiring();
 	void ReloadMagazine();
+	template <bool DiscardsMagazine, bool InfiniteReserve>
+	void ReloadMagazineWith();
+	void CompleteReloading();
 	void NotifyStatusUpdate();
+	void UpdateTickEnabled();
+	void SimulateFiring();
 
 	double LastFireTimestamp;
+	// TimestampIntegerBased clock: shot N is due at FiringEpochNs + N * 60s / FireRateRpm
+	int64 FiringEpochNs;
+	int64 NextShotIndex;
+	int64 GetShotTimestampNs(int64 ShotIndex) const;
+	int64 GetLastShotIndexDueAt(int64 TimestampNs) const;
+	double GetNextShotTimestamp() const;
 	double SecondsBetweenEachShot;
-	double ReloadTimestamp;
+	FTimerHandle ReloadTimerHandle;
 	int CurrentBurstFiringCount;
 
-	double MissedShotsThisFrame;
+	// Muzzle as it was the last time the weapon has been updated while firing
+	FTransform PreviousMuzzleTransform;
+	double PreviousMuzzleTimestamp;
 
 	EBallisticWeaponStatus Status;
 
@@ -257,11 +464,49 @@ protected:
 		return std::bit_cast<uint8>(StatusNotificationQueue) != 0;
 	}
 
+	TArray<IBallisticWeaponListener*, TInlineAllocator<2>> Listeners;
+	// What OnShotsFired will report, only filled while there are listeners
+	TArray<double> PendingShotTimestamps;
+	TArray<FHitResult> PendingShotHits;
+
+	void NotifyListeners(FNotifyQueueFlags Notifications);
+
 public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
 	                           FActorComponentTickFunction* ThisTickFunction) override;
 
 private:
+	friend class UWeaponSimulationSubsystem;
+	friend class UHitScanBatchSubsystem;
+	friend class UBallisticImpactSubsystem;
+
+	// Index inside UWeaponSimulationSubsystem, INDEX_NONE if not simulated
+	int32 SimulationIndex = INDEX_NONE;
+	// Whether SimulateFiring() has something to do at Now. Only reads, so it can run outside the game thread.
+	bool NeedsFiringUpdate(double Now) const;
+
+#if !UE_BUILD_SHIPPING
+	// Settings the fire policies have been selected for
+	struct FFirePolicySettings
+	{
+		EBallisticWeaponFiringStrategy FiringStrategy;
+		bool IsBurstFire;
+		bool HasInfiniteAmmo;
+		bool HasInfiniteAmmoReserve;
+		bool ReloadingDiscardsEntireMagazine;
+		bool IsHitScan;
+		bool IsBallistic;
+		bool UseBatchedHitScan;
+
+		bool operator==(const FFirePolicySettings&) const = default;
+	};
+
+	FFirePolicySettings SelectedFirePolicySettings;
+	FFirePolicySettings MakeFirePolicySettings() const;
+	// Catches the settings assigned from native code while playing, without selecting the policies again
+	void EnsureFirePolicyIsCurrent() const;
+#endif
+
 #if WITH_EDITORONLY_DATA
 	UPROPERTY()
 	TObjectPtr<UArrowComponent> BulletExitDirection;
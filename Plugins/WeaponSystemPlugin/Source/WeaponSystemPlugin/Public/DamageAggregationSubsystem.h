@@ -0,0 +1,111 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DamageEvents.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DamageAggregationSubsystem.generated.h"
+
+/**
+ * Damage of several hits applied with a single TakeDamage call by UDamageAggregationSubsystem.
+ */
+struct WEAPONSYSTEMPLUGIN_API FAggregatedDamageEvent : public FDamageEvent
+{
+	// Hits summed up in this event, for the receivers that count them
+	int32 HitCount = 1;
+
+	static const int32 ClassID = 3;
+
+	FAggregatedDamageEvent() = default;
+
+	FAggregatedDamageEvent(TSubclassOf<UDamageType> InDamageTypeClass, int32 InHitCount)
+		: FDamageEvent(InDamageTypeClass), HitCount(InHitCount)
+	{
+	}
+
+	virtual int32 GetTypeID() const override { return ClassID; }
+	virtual bool IsOfType(int32 InID) const override { return ClassID == InID || FDamageEvent::IsOfType(InID); }
+
+	// Hits carried by any damage event, 1 unless it has been aggregated.
+	static int32 GetHitCount(const FDamageEvent& DamageEvent);
+};
+
+/**
+ * Damage of one or more explosions, applied with a single TakeDamage call by UDamageAggregationSubsystem.
+ * The damage is already scaled by distance. Origin and Params are the ones of the explosion that dealt the most damage.
+ */
+struct WEAPONSYSTEMPLUGIN_API FAggregatedRadialDamageEvent : public FAggregatedDamageEvent
+{
+	FVector Origin = FVector::ZeroVector;
+	FRadialDamageParams Params;
+
+	static const int32 ClassID = 4;
+
+	FAggregatedRadialDamageEvent() = default;
+
+	FAggregatedRadialDamageEvent(TSubclassOf<UDamageType> InDamageTypeClass, int32 InHitCount, const FVector& InOrigin,
+	                             const FRadialDamageParams& InParams)
+		: FAggregatedDamageEvent(InDamageTypeClass, InHitCount), Origin(InOrigin), Params(InParams)
+	{
+	}
+
+	virtual int32 GetTypeID() const override { return ClassID; }
+	virtual bool IsOfType(int32 InID) const override { return ClassID == InID || FAggregatedDamageEvent::IsOfType(InID); }
+};
+
+/**
+ * Queues the damage dealt during a frame and sums it per target, instigator and damage type,
+ * so each of them receives a single TakeDamage call per frame instead of one per hit.
+ * Radial damage is summed apart and applied with FAggregatedRadialDamageEvent.
+ * Pending damage is applied when the subsystem ticks, or earlier by calling Flush.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UDamageAggregationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FPendingDamage
+	{
+		TWeakObjectPtr<AActor> Target;
+		TWeakObjectPtr<AController> Instigator;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TSubclassOf<UDamageType> DamageType;
+		float Damage = 0;
+		int32 HitCount = 0;
+		bool IsRadial = false;
+		// Explosion that dealt the most damage, for FAggregatedRadialDamageEvent
+		float StrongestRadialDamage = 0;
+		FVector Origin = FVector::ZeroVector;
+		FRadialDamageParams Params;
+	};
+
+	using FPendingDamageKey = TTuple<const AActor*, const AController*, const UClass*, bool>;
+
+	// In queue order, so damage is applied deterministically
+	TArray<FPendingDamage> PendingDamage;
+	TMap<FPendingDamageKey, int32> PendingDamageIndices;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void QueueDamage(AActor* Target, float Damage, TSubclassOf<UDamageType> DamageType, AController* Instigator,
+	                 AActor* DamageCauser, int32 HitCount = 1);
+
+	// Damage already scaled by the distance from Origin.
+	void QueueRadialDamage(AActor* Target, float Damage, TSubclassOf<UDamageType> DamageType, AController* Instigator,
+	                       AActor* DamageCauser, const FVector& Origin, const FRadialDamageParams& Params);
+
+	// Applies all the pending damage immediately.
+	void Flush();
+
+	int32 Num() const;
+
+protected:
+	FPendingDamage& FindOrAddPendingDamage(AActor* Target, TSubclassOf<UDamageType> DamageType, AController* Instigator,
+	                                       AActor* DamageCauser, bool IsRadial);
+};
@@ -0,0 +1,48 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ScalableFloat.h"
+
+/**
+ * Damage curve sampled at a fixed distance step, so evaluating it is a clamp and a lerp
+ * instead of a curve lookup and a keys search.
+ * Distances beyond the baked range get the value of the last sample.
+ */
+struct WEAPONSYSTEMPLUGIN_API FDamageFalloffTable
+{
+	// Samples Curve from 0 to MaxDistance. Logs a warning if WeaponSystem.DamageFalloff.ValidationTolerance is exceeded.
+	void Bake(const FScalableFloat& Curve, float MaxDistance, int32 NumSamples);
+
+	void Reset();
+
+	bool IsBaked() const
+	{
+		return !Samples.IsEmpty();
+	}
+
+	float Evaluate(float Distance) const
+	{
+		checkSlow(IsBaked());
+		// Clamped, so even the last sample has a segment on its right
+		const float Position = FMath::Clamp(Distance * InvDistanceStep, 0.f, LastSegmentEnd);
+		const int32 Index = FMath::Min(static_cast<int32>(Position), Samples.Num() - 2);
+		const float* Data = Samples.GetData();
+		return FMath::Lerp(Data[Index], Data[Index + 1], Position - Index);
+	}
+
+	// Largest absolute difference from Curve, checked at NumTestPoints evenly spaced distances.
+	float CalculateMaxError(const FScalableFloat& Curve, int32 NumTestPoints) const;
+
+	int32 Num() const
+	{
+		return Samples.Num();
+	}
+
+private:
+	TArray<float> Samples;
+	float InvDistanceStep = 0;
+	float LastSegmentEnd = 0;
+	float MaxDistance = 0;
+};
@@ -0,0 +1,21 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "DamageableComponent.generated.h"
+
+/**
+ * Registers its owner to UDamageableSpatialHashSubsystem,
+ * making it a target for homing rounds, proximity fuses and batched radial damage.
+ */
+UCLASS(ClassGroup=("Weapon Components"), meta=(BlueprintSpawnableComponent))
+class WEAPONSYSTEMPLUGIN_API UDamageableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,104 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "DamageableSpatialHashSubsystem.generated.h"
+
+/**
+ * Uniform grid of the damageable Actors registered to it, for homing and proximity queries that don't touch physics.
+ * Actors are registered by UDamageableComponent or Register, and unregistered on EndPlay.
+ * Each tick only the Actors that moved to another cell are re-hashed.
+ * Queries are read-only and skip the Actors destroyed since the last update, the batched ones run with ParallelFor.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UDamageableSpatialHashSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Actors;
+
+	// Indexed like Actors. Keys stay valid after garbage collection nulls an Actor, so it can still be removed.
+	TArray<TObjectKey<AActor>> ActorKeys;
+	TArray<FVector> Locations;
+	TArray<FIntVector> CellKeys;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+	TMap<TObjectKey<AActor>, int32> ActorIndices;
+	float CellSize = 1000;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	UFUNCTION(BlueprintCallable)
+	void Register(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable)
+	void Unregister(AActor* Actor);
+
+	// Re-hashes the Actors that moved, and drops the destroyed ones.
+	void Update();
+
+	// Appends every Actor within Radius from Location.
+	void FindInRadius(const FVector& Location, float Radius, TArray<AActor*>& OutActors,
+	                  const AActor* IgnoredActor = nullptr) const;
+
+	// The nearest Actor within MaxRadius from Location, nullptr if there's none.
+	AActor* FindNearest(const FVector& Location, float MaxRadius, const AActor* IgnoredActor = nullptr) const;
+
+	// Up to K Actors within MaxRadius from Location, nearest first.
+	void FindNearest(const FVector& Location, int32 K, float MaxRadius, TArray<AActor*>& OutActors,
+	                 const AActor* IgnoredActor = nullptr) const;
+
+	// The nearest Actor within MaxRadius from each location, nullptr if there's none.
+	void FindNearestBatch(TConstArrayView<FVector> QueryLocations, float MaxRadius, TArrayView<AActor*> OutNearest) const;
+
+	int32 Num() const;
+
+protected:
+	FIntVector GetCellKey(const FVector& Location) const;
+	void AddToCell(int32 Index);
+	void RemoveFromCell(int32 Index);
+	void RemoveAt(int32 Index);
+
+	UFUNCTION()
+	void HandleActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	template <typename TFunc>
+	void ForEachWithinRadius(const FVector& Location, float Radius, TFunc&& Func) const
+	{
+		const FIntVector MinKey = GetCellKey(Location - FVector(Radius));
+		const FIntVector MaxKey = GetCellKey(Location + FVector(Radius));
+		const double RadiusSquared = FMath::Square(Radius);
+		for (int32 X = MinKey.X; X <= MaxKey.X; ++X)
+		{
+			for (int32 Y = MinKey.Y; Y <= MaxKey.Y; ++Y)
+			{
+				for (int32 Z = MinKey.Z; Z <= MaxKey.Z; ++Z)
+				{
+					const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, Z));
+					if (!Cell)
+					{
+						continue;
+					}
+					for (const int32 Index : *Cell)
+					{
+						const double DistanceSquared = FVector::DistSquared(Location, Locations[Index]);
+						if (DistanceSquared <= RadiusSquared && IsValid(Actors[Index]))
+						{
+							Func(Index, DistanceSquared);
+						}
+					}
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,62 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HitScanBatchSubsystem.generated.h"
+
+class UBallisticWeaponComponent;
+struct FBallisticWeaponShot;
+
+/**
+ * Collects the hit-scan shots of every weapon with UseBatchedHitScan, and traces them as a single batch
+ * once every Actor, component and tickable object of the World has ticked, in parallel against the physics scene.
+ * Shots fired by components or by UWeaponSimulationSubsystem are then always resolved in the frame they're fired.
+ * Unlike async traces, results are available in the same frame they have been requested,
+ * and damage is applied on the game thread in shot timestamp order, so it's deterministic.
+ * Weapons with UseServerRewind have their targets rewound once per batch, for all their shots.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UHitScanBatchSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FRequest
+	{
+		TWeakObjectPtr<UBallisticWeaponComponent> Weapon;
+		double Timestamp;
+		FVector Start;
+		FVector End;
+	};
+
+	TArray<FRequest> Requests;
+	// Swapped with Requests while flushing
+	TArray<FRequest> ResolvingRequests;
+	// Resolved on the game thread before tracing, nullptr if the Weapon is gone
+	TArray<const UBallisticWeaponComponent*> Weapons;
+	// Kept across frames, so the inner arrays don't reallocate
+	TArray<TArray<FHitResult>> Hits;
+	// Requests grouped by the weapon rewinding their targets, if any
+	TArray<int32> TraceOrder;
+	TArray<int32> ResolutionOrder;
+
+	FDelegateHandle PostActorTickHandle;
+
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	// Traces the requests at Indices, in parallel when they're enough.
+	void TraceRequests(TConstArrayView<int32> Indices);
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	void Enqueue(UBallisticWeaponComponent* Weapon, const FBallisticWeaponShot& Shot);
+
+	// Traces and resolves all the pending requests immediately.
+	void Flush();
+
+	int32 Num() const;
+};
@@ -0,0 +1,97 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HitboxComponent.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HitboxBVHSubsystem.generated.h"
+
+/**
+ * Bounding volume hierarchy of the hitboxes registered by UHitboxComponent,
+ * so hit-scan rounds can be tested against characters without touching the physics scene.
+ * The hitboxes are moved to their bones and the hierarchy is rebuilt once per frame, when the subsystem ticks,
+ * or earlier by calling Refresh. Raycasts are read-only and can run on any thread in between.
+ * Owners offset by URewindHistorySubsystem aren't rebuilt: the rays are moved into the space they've been built in.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UHitboxBVHSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FNode
+	{
+		FVector Min;
+		FVector Max;
+		// Leaves: range inside ShapeOrder. Inner nodes: the left child follows the node, RightChild is the other one
+		int32 First;
+		int32 Count;
+		int32 RightChild;
+	};
+
+	UPROPERTY()
+	TArray<TObjectPtr<UHitboxComponent>> Components;
+
+	// Resolved by Refresh, indexed like Components, nullptr once unregistered
+	TArray<const AActor*> ComponentOwners;
+	TArray<UPrimitiveComponent*> ComponentPrimitives;
+
+	// One entry for each hitbox in world space, rebuilt by Refresh
+	TArray<EHitboxShapeType> ShapeTypes;
+	TArray<FVector> ShapeCenters;
+	TArray<FQuat> ShapeRotations;
+	// Sphere: radius in X. Capsule: radius in X, half length of the segment between the caps in Z. Box: its extent.
+	TArray<FVector> ShapeSizes;
+	TArray<FVector> ShapeMins;
+	TArray<FVector> ShapeMaxs;
+	TArray<int32> ShapeComponents;
+	TArray<FName> ShapeBones;
+
+	TArray<int32> ShapeOrder;
+	TArray<FNode> Nodes;
+
+	// Where the hitboxes of their owner are hit, on top of their bones, ie. set by URewindHistorySubsystem while rewinding it
+	TMap<const AActor*, FTransform> OwnerOffsets;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void Register(UHitboxComponent* Component);
+	void Unregister(UHitboxComponent* Component);
+
+	// Moves every hitbox to its bone and rebuilds the hierarchy.
+	void Refresh();
+
+	// The hitboxes of Owner are hit as if moved by Offset, in world space, until the offsets are reset.
+	// Offset must be rigid. Takes effect immediately, without a Refresh.
+	void SetOwnerOffset(const AActor* Owner, const FTransform& Offset);
+	void ResetOwnerOffsets();
+	bool HasOwnerOffsets() const;
+
+	// Finds the nearest hitbox crossed by the segment from Start to End, skipping the ones of IgnoredActor.
+	// OutHit gets the owner of the hitbox as Actor and its bone as BoneName. Can be called from any thread.
+	bool Raycast(const FVector& Start, const FVector& End, FHitResult& OutHit,
+	             const AActor* IgnoredActor = nullptr) const;
+
+	// Skips the hitboxes of every IgnoredActors instead.
+	bool Raycast(const FVector& Start, const FVector& End, FHitResult& OutHit,
+	             TConstArrayView<const AActor*> IgnoredActors) const;
+
+	// Hitboxes in the hierarchy as of the last Refresh.
+	int32 Num() const;
+
+protected:
+	int32 BuildNode(int32 First, int32 Count);
+	// Nearest shape crossed by the ray within InOutNearestDistance, which is shortened to it. Only the shapes of
+	// OffsetOwner are tested when set, otherwise the ones whose owner has no offset. INDEX_NONE if none is crossed.
+	int32 RaycastShapes(const FVector& Origin, const FVector& Direction, TConstArrayView<const AActor*> IgnoredActors,
+	                    const AActor* OffsetOwner, double& InOutNearestDistance, FVector& OutNormal) const;
+	// Distance along Direction at which the ray enters the shape, or a negative number if it misses it within MaxDistance
+	double IntersectShape(int32 Shape, const FVector& Origin, const FVector& Direction, double MaxDistance,
+	                      FVector& OutNormal) const;
+};
@@ -0,0 +1,73 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HitboxComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EHitboxShapeType : uint8
+{
+	Sphere,
+	// Aligned with the Z axis of the shape
+	Capsule,
+	Box
+};
+
+/**
+ * A lightweight hit-scan target following a bone, tested by UHitboxBVHSubsystem instead of the physics scene.
+ * Sizes are in world units, the scale of the bone isn't applied.
+ */
+USTRUCT(BlueprintType)
+struct WEAPONSYSTEMPLUGIN_API FHitboxShape
+{
+	GENERATED_BODY()
+
+	// Bone or socket the shape is attached to, None attaches it to the source component itself.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox")
+	FName BoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox")
+	EHitboxShapeType Type = EHitboxShapeType::Sphere;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox")
+	FVector Offset = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox")
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox",
+		meta=(EditCondition="Type != EHitboxShapeType::Box", UIMin=0, ClampMin=0, Units="cm"))
+	float Radius = 10;
+
+	// Caps included, like UCapsuleComponent.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox",
+		meta=(EditCondition="Type == EHitboxShapeType::Capsule", UIMin=0, ClampMin=0, Units="cm"))
+	float HalfHeight = 20;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox",
+		meta=(EditCondition="Type == EHitboxShapeType::Box", Units="cm"))
+	FVector BoxExtent = FVector(10);
+};
+
+/**
+ * Registers the hitboxes of its owner to UHitboxBVHSubsystem.
+ * The owner's own collision shouldn't block the hit-scan channel, or the physics fallback would hit it first.
+ */
+UCLASS(ClassGroup=("Weapon Components"), meta=(BlueprintSpawnableComponent))
+class WEAPONSYSTEMPLUGIN_API UHitboxComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hitbox")
+	TArray<FHitboxShape> Shapes;
+
+	// Component the bones are looked up in. If not set on BeginPlay, it's the owner's first skinned mesh or its root.
+	UPROPERTY(BlueprintReadWrite, Category="Hitbox")
+	TObjectPtr<USceneComponent> SourceComponent;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DamageFalloffTable.h"
 #include "PoolableActor.h"
 #include "ScalableFloat.h"
 
@@ -18,6 +19,19 @@ class WEAPONSYSTEMPLUGIN_API AProjectileBase : public AActor, public IPoolableAc
 
 	float InitialSpeed;
 	bool IsActorHiddenAtBeginPlay;
+	// Only baked on the class defaults, shared by every round of the class
+	FDamageFalloffTable DamageFalloff;
+	// Index inside UProjectileVisualsSubsystem, INDEX_NONE if not instanced
+	int32 VisualInstanceIndex = INDEX_NONE;
+	// False while in the pool
+	bool IsInFlight = false;
+
+	void SetInFlight(bool NewInFlight);
+
+	UFUNCTION()
+	void HandleActorBeginOverlap(AActor* OverlappedActor, AActor* OtherActor);
+
+	friend class UProjectileVisualsSubsystem;
 
 public:
 	AProjectileBase();
@@ -30,6 +44,28 @@ public:
 
 	UPROPERTY(EditDefaultsOnly, Category="Collision")
 	bool EnableSpawnOffsetToAvoidWeaponCollision = true;
+
+	// Hits are found by sweeping the path flown since the last tick, instead of by overlap events,
+	// so fast rounds can't tunnel through thin targets.
+	UPROPERTY(EditDefaultsOnly, Category="Collision")
+	bool UseSweptCollision = false;
+
+	UPROPERTY(EditDefaultsOnly, Category="Collision", meta=(EditCondition="UseSweptCollision"))
+	TEnumAsByte<ECollisionChannel> SweepCollisionChannel = TEnumAsByte(ECC_Visibility);
+
+	// 0 traces a line instead of sweeping a sphere.
+	UPROPERTY(EditDefaultsOnly, Category="Collision",
+		meta=(EditCondition="UseSweptCollision", UIMin=0, ClampMin=0, Units="cm"))
+	float SweepRadius = 0;
+
+	// A curved path is split into chords of about this length.
+	UPROPERTY(EditDefaultsOnly, Category="Collision",
+		meta=(EditCondition="UseSweptCollision", UIMin=1, ClampMin=1, Units="cm"))
+	float SweepSubStepLength = 500;
+
+	// Upper bound of the chords swept each tick.
+	UPROPERTY(EditDefaultsOnly, Category="Collision", meta=(EditCondition="UseSweptCollision", UIMin=1, ClampMin=1))
+	int MaxSweepSubSteps = 4;
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Damage")
 	FScalableFloat Damage;
@@ -37,7 +73,97 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Damage")
 	TSubclassOf<UDamageType> DamageType;
 
+	// Damage is baked once per class into a lookup table with this many samples, up to the last key of its curve.
+	// 0 evaluates the curve on every hit.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Damage", meta=(UIMin=0, ClampMin=0))
+	int DamageFalloffSamples = 64;
+
+	// Steers towards the nearest Actor registered to UDamageableSpatialHashSubsystem,
+	// with ProjectileMovementComponent's HomingAccelerationMagnitude.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Homing")
+	bool UseHoming = false;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Homing",
+		meta=(EditCondition="UseHoming", UIMin=1, ClampMin=1, Units="cm"))
+	float HomingSearchRadius = 3000;
+
+	// The nearest target is searched again this often, 0 searches every tick.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Homing",
+		meta=(EditCondition="UseHoming", UIMin=0, ClampMin=0, Units="s"))
+	float HomingRetargetInterval = 0.25f;
+
+	// The round detonates on the nearest Actor registered to UDamageableSpatialHashSubsystem within this radius.
+	// 0 disables the proximity fuse.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Damage", meta=(UIMin=0, ClampMin=0, Units="cm"))
+	float ProximityFuseRadius = 0;
+
+	// On impact the round explodes, damaging every Actor in range through URadialDamageBatchSubsystem
+	// instead of only the one it has hit. Damage at the center is the one at the distance traveled.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion")
+	bool UseRadialDamage = false;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion",
+		meta=(EditCondition="UseRadialDamage", UIMin=0, ClampMin=0, Units="cm"))
+	float ExplosionInnerRadius = 0;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion",
+		meta=(EditCondition="UseRadialDamage", UIMin=1, ClampMin=1, Units="cm"))
+	float ExplosionOuterRadius = 500;
+
+	// Damage dealt at ExplosionOuterRadius.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion",
+		meta=(EditCondition="UseRadialDamage", UIMin=0, ClampMin=0))
+	float ExplosionMinimumDamage = 0;
+
+	// Exponent of the falloff between the two radii, 1 is linear.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion",
+		meta=(EditCondition="UseRadialDamage", UIMin=0, ClampMin=0))
+	float ExplosionDamageFalloff = 1;
+
+	// Targets hidden from the explosion by something blocking ExplosionOcclusionChannel aren't damaged.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion", meta=(EditCondition="UseRadialDamage"))
+	bool ExplosionTraceOcclusion = true;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Explosion",
+		meta=(EditCondition="UseRadialDamage && ExplosionTraceOcclusion"))
+	TEnumAsByte<ECollisionChannel> ExplosionOcclusionChannel = TEnumAsByte(ECC_Visibility);
+
+	// Damage goes through UDamageAggregationSubsystem, so each target is damaged once per frame.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Performance")
+	bool UseDamageAggregation = false;
+
+	// The mesh is drawn by UProjectileVisualsSubsystem, instanced together with the other projectiles of this class.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Performance")
+	bool UseInstancedVisuals = false;
+
+	// Rounds are simulated as plain data by UProjectileSimulationSubsystem, no Actor is spawned for them.
+	// Only this class' defaults are used: InitialSpeed and ProjectileGravityScale of ProjectileMovementComponent,
+	// the Simulation settings for drag and collision. Rounds stop at the first hit.
+	// Rounds using homing or the proximity fuse always spawn an Actor, see CanBeSimulatedWithoutActor.
+	// The Simulation settings also apply to the virtual rounds of FAmmoType::TracerEveryNthRound.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Simulation")
+	bool SimulateWithoutActor = false;
+
+	// Quadratic air drag, in 1/cm.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Simulation",
+		meta=(EditCondition="SimulateWithoutActor", UIMin=0, ClampMin=0))
+	float SimulatedDragCoefficient = 0;
+
+	// 0 traces a line instead of sweeping a sphere.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Simulation",
+		meta=(EditCondition="SimulateWithoutActor", UIMin=0, ClampMin=0, Units="cm"))
+	float SimulatedCollisionRadius = 0;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Simulation",
+		meta=(EditCondition="SimulateWithoutActor", UIMin=0.01, ClampMin=0.01, Units="s"))
+	float SimulatedLifetime = 10;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Simulation", meta=(EditCondition="SimulateWithoutActor"))
+	TEnumAsByte<ECollisionChannel> SimulatedCollisionChannel = TEnumAsByte(ECC_Visibility);
+
 	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void AcquiredFromPool(const FTransform& NewTransform, AActor* NewOwner) override;
 	virtual void ReleasedToPool() override;
 
@@ -49,16 +175,55 @@ public:
 	bool ShouldTraceLineEachHit = false;
 #endif
 
+	// Bakes the damage falloff table of the class, if it hasn't been baked yet.
+	void BakeDamageFalloff() const;
+
+	// Homing and the proximity fuse need an Actor to search for targets from.
+	bool CanBeSimulatedWithoutActor() const;
+
 protected:
+	friend class UProjectileSimulationSubsystem;
+
 	UPROPERTY(BlueprintReadOnly)
 	FVector SpawnLocation;
 
+	// Length of the path flown so far, only tracked with UseSweptCollision
+	UPROPERTY(BlueprintReadOnly)
+	double TraveledDistance;
+
+	// Last hit found with UseSweptCollision, with the exact impact point
+	UPROPERTY(BlueprintReadOnly)
+	FHitResult LastSweptHit;
+
+	FVector PreviousSweepLocation;
+	FVector PreviousSweepVelocity;
+	// Rounds that survive a hit go through what they've hit
+	TArray<TWeakObjectPtr<AActor>, TInlineAllocator<4>> SweptActorsHit;
+
+	float HomingRetargetCountdown = 0;
+
+	void SweepSinceLastTick(float DeltaSeconds);
+	void UpdateHomingTarget(float DeltaSeconds);
+	// Returns true if the round has been released
+	bool CheckProximityFuse();
+	// Returns true if the round has been released
+	bool HandleSweptHit(const FHitResult& Hit, double Distance);
+
+	// Damages ActorToDamage on behalf of DamageOwner, directly or through UDamageAggregationSubsystem.
+	void DealDamage(AActor* ActorToDamage, double TotalTraveledDistance, AActor* DamageOwner);
+
+	// Explodes at ImpactLocation with UseRadialDamage, otherwise damages ActorHit, if any.
+	// World is explicit because simulated rounds call this on the class defaults.
+	void DealImpactDamage(UWorld* World, AActor* ActorHit, const FVector& ImpactLocation,
+	                      double TotalTraveledDistance, AActor* DamageOwner);
+
 	UFUNCTION(BlueprintCallable)
 	bool ShouldIgnoreHit(AActor* ActorHit) const;
 	
 	UFUNCTION(BlueprintNativeEvent)
 	void OnActorOverlap(AActor* OverlappedActor, AActor* OtherActor);
 
+	// Also called after a swept hit.
 	UFUNCTION(BlueprintNativeEvent)
 	bool ShouldDestroyAfterOverlap();
 
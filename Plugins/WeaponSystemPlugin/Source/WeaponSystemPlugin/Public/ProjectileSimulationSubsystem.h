@@ -0,0 +1,71 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectileSimulationSubsystem.generated.h"
+
+class AProjectileBase;
+
+struct FSimulatedProjectileHit
+{
+	// Class defaults of the round
+	const AProjectileBase* Archetype;
+	TWeakObjectPtr<AActor> Owner;
+	FHitResult Hit;
+	// Length of the path flown by the round
+	double TraveledDistance;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSimulatedProjectileHit, const FSimulatedProjectileHit&);
+
+/**
+ * Flies the rounds of every AProjectileBase class with SimulateWithoutActor, as structure-of-arrays data.
+ * Each tick integrates gravity and drag for all of them in one pass, then sweeps every round from its previous
+ * to its new position as a batch, in parallel against the physics scene.
+ * Hits are resolved on the game thread: damage is dealt through the class defaults and OnHit is broadcast.
+ * Finished rounds are swapped out, so the resolution order among the hits of a tick isn't the launch order.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UProjectileSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	// Class defaults, alive as long as their class is loaded
+	TArray<AProjectileBase*> Archetypes;
+	TArray<TWeakObjectPtr<AActor>> Owners;
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> GravityZ;
+	TArray<float> DragCoefficients;
+	TArray<float> RemainingLifetimes;
+	TArray<double> TraveledDistances;
+
+	// Scratch, indexed like the rounds
+	TArray<FVector> NewPositions;
+	TArray<const AActor*> IgnoredActors;
+	TArray<FHitResult> Hits;
+	TArray<bool> HasHit;
+	TArray<int32> FinishedRounds;
+
+public:
+	FOnSimulatedProjectileHit OnHit;
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void Launch(AProjectileBase* Archetype, const FVector& Location, const FVector& Direction, AActor* Owner);
+
+	// Advances every round by DeltaTime.
+	void Simulate(float DeltaTime);
+
+	int32 Num() const;
+
+protected:
+	void RemoveRound(int32 Index);
+};
@@ -0,0 +1,63 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectileVisualsSubsystem.generated.h"
+
+class AProjectileBase;
+class UInstancedStaticMeshComponent;
+
+USTRUCT()
+struct FProjectileInstancedVisuals
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> Component;
+
+	// Instance N draws Projectiles[N]
+	UPROPERTY()
+	TArray<TObjectPtr<AProjectileBase>> Projectiles;
+};
+
+/**
+ * Draws the projectiles with UseInstancedVisuals through one UInstancedStaticMeshComponent per projectile class,
+ * instead of a primitive and a scene proxy per projectile.
+ * Projectiles keep their collision and movement, only their mesh is hidden:
+ * at the end of the frame the instance transforms are copied from the projectiles in a single batch update.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UProjectileVisualsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	friend class AProjectileBase;
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FProjectileInstancedVisuals> VisualsPerClass;
+
+
+	TArray<FTransform> Transforms;
+	TArray<FTransform> NewInstanceTransforms;
+	TArray<int32> InstancesToRemove;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// Copies the projectiles' transforms to their instances.
+	void UpdateInstances();
+
+	const UInstancedStaticMeshComponent* GetInstancedMeshComponent(TSubclassOf<AProjectileBase> ProjectileClass) const;
+
+	int32 Num() const;
+
+protected:
+	void Register(AProjectileBase* Projectile);
+	void Unregister(AProjectileBase* Projectile);
+};
@@ -0,0 +1,74 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RadialDamageBatchSubsystem.generated.h"
+
+/**
+ * A single explosion queued to URadialDamageBatchSubsystem.
+ * Damage goes from BaseDamage within InnerRadius to MinimumDamage at OuterRadius, like FRadialDamageParams.
+ * An OuterRadius not greater than InnerRadius deals BaseDamage up to OuterRadius.
+ */
+struct WEAPONSYSTEMPLUGIN_API FRadialDamageExplosion
+{
+	FVector Origin = FVector::ZeroVector;
+	float BaseDamage = 0;
+	float MinimumDamage = 0;
+	float InnerRadius = 0;
+	float OuterRadius = 0;
+	float DamageFalloff = 1;
+	TSubclassOf<UDamageType> DamageType;
+	TWeakObjectPtr<AController> Instigator;
+	TWeakObjectPtr<AActor> DamageCauser;
+	// Targets hidden from Origin by something blocking this channel aren't damaged
+	bool TraceOcclusion = true;
+	TEnumAsByte<ECollisionChannel> OcclusionChannel = ECC_Visibility;
+
+	float GetDamageAtDistance(float Distance) const;
+};
+
+/**
+ * Resolves every explosion of the frame as a single batch:
+ * targets are gathered from UDamageableSpatialHashSubsystem, the falloff is computed in a flat pass,
+ * occlusion is traced in parallel, and damage is summed by UDamageAggregationSubsystem,
+ * so each target receives one TakeDamage call with FAggregatedRadialDamageEvent,
+ * no matter how many explosions have reached it.
+ * Only the Actors registered to UDamageableSpatialHashSubsystem can be damaged.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API URadialDamageBatchSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	TArray<FRadialDamageExplosion> Explosions;
+	// Swapped with Explosions while resolving them, so damage can queue more explosions for the next batch
+	TArray<FRadialDamageExplosion> ResolvingExplosions;
+	// Resolved on the game thread before tracing, indexed like ResolvingExplosions
+	TArray<const AActor*> DamageCausers;
+
+	// One entry for each explosion and target in range, grouped by explosion.
+	// Kept across frames, so they don't reallocate.
+	TArray<int32> PairExplosions;
+	TArray<AActor*> PairTargets;
+	TArray<float> PairDistances;
+	TArray<float> PairDamages;
+	TArray<bool> PairVisible;
+	TArray<AActor*> TargetsInRange;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void QueueExplosion(const FRadialDamageExplosion& Explosion);
+
+	// Applies the damage of all the pending explosions immediately.
+	void Flush();
+
+	int32 Num() const;
+};
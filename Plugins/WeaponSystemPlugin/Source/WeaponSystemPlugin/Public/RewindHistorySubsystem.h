@@ -0,0 +1,99 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RewindHistorySubsystem.generated.h"
+
+/**
+ * Records the transform of the tracked Actors every frame, so hit-scan can be traced against where they were
+ * when the shooter saw them, ie. by a dedicated server compensating the shooter's latency.
+ * Each Actor gets a ring buffer of WeaponSystem.Rewind.HistorySize samples, allocated when it's registered,
+ * so recording doesn't allocate and both memory and time are bounded per tracked Actor.
+ * Rewinding teleports only the physics bodies used by queries and offsets the hitboxes of UHitboxBVHSubsystem,
+ * without rebuilding it. The Actors keep their transform so no overlap, movement or attachment update is triggered.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API URewindHistorySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Actors;
+
+	// Next sample to write and samples written so far, indexed like Actors
+	TArray<int32> Heads;
+	TArray<int32> Counts;
+
+	// HistorySize samples for each Actor, one after the other, indexed like Actors
+	TArray<double> Timestamps;
+	TArray<FVector> Locations;
+	TArray<FQuat> Rotations;
+
+	// Actors whose bodies or hitboxes have been moved by RewindTo, indexed like Actors
+	TArray<bool> RewoundActors;
+
+	int32 HistorySize = 64;
+	bool IsRewound = false;
+	bool AreHitboxesRewound = false;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	void Register(AActor* Actor);
+	void Unregister(AActor* Actor);
+
+	// Records the current transform of every tracked Actor, called on Tick with the World time.
+	void Record(double Timestamp);
+
+	// Transform of Actor at Timestamp, interpolated between the two nearest samples and clamped to the recorded ones.
+	// False if Actor isn't tracked or has no samples yet.
+	bool GetTransformAt(const AActor* Actor, double Timestamp, FTransform& OutTransform) const;
+
+	// Moves every tracked Actor but IgnoredActor to where it was at Timestamp, until Restore is called.
+	// When Region is set, only the Actors that were overlapping it are moved, ie. the ones a shot can reach.
+	void RewindTo(double Timestamp, const AActor* IgnoredActor = nullptr, const TOptional<FSphere>& Region = {});
+	void Restore();
+	// Between RewindTo and Restore.
+	bool IsRewinding() const;
+
+	int32 Num() const;
+
+	// Memory taken by the history of a single Actor.
+	SIZE_T GetBytesPerTrackedActor() const;
+
+protected:
+	void RemoveAt(int32 Index);
+	int32 GetSampleIndex(int32 ActorIndex, int32 Sample) const;
+	FTransform SampleAt(int32 ActorIndex, double Timestamp) const;
+	void UpdateMemoryStat() const;
+};
+
+/**
+ * Rewinds the tracked Actors for as long as it's in scope.
+ */
+struct WEAPONSYSTEMPLUGIN_API FRewindHistoryScope
+{
+	FRewindHistoryScope(URewindHistorySubsystem* InHistory, double Timestamp, const AActor* IgnoredActor = nullptr,
+	                    const TOptional<FSphere>& Region = {})
+		: History(InHistory)
+	{
+		History->RewindTo(Timestamp, IgnoredActor, Region);
+	}
+
+	~FRewindHistoryScope()
+	{
+		History->Restore();
+	}
+
+	UE_NONCOPYABLE(FRewindHistoryScope);
+
+private:
+	URewindHistorySubsystem* History;
+};
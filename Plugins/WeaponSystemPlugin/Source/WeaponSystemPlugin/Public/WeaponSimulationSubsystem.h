@@ -0,0 +1,42 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WeaponSimulationSubsystem.generated.h"
+
+class UBallisticWeaponComponent;
+
+/**
+ * Updates every firing UBallisticWeaponComponent that opted in via UseSimulationSubsystem, in a single pass.
+ * The decision pass only reads the components, so it can run on multiple threads, one chunk of weapons per task.
+ * Only the weapons that have to fire or stop firing are then handed back to the game thread, in registration order.
+ */
+UCLASS()
+class WEAPONSYSTEMPLUGIN_API UWeaponSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	friend class UBallisticWeaponComponent;
+
+	UPROPERTY()
+	TArray<TObjectPtr<UBallisticWeaponComponent>> Weapons;
+
+	// Output of the decision pass, each chunk of weapons fills its own list so the tasks never share a cache line
+	TArray<TArray<UBallisticWeaponComponent*>> WeaponsToUpdatePerChunk;
+	TArray<UBallisticWeaponComponent*> WeaponsToUpdate;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	int32 Num() const;
+
+protected:
+	void Register(UBallisticWeaponComponent* Weapon);
+	void Unregister(UBallisticWeaponComponent* Weapon);
+};
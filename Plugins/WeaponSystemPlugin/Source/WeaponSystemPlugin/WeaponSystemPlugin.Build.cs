@@ -21,7 +21,8 @@ public class WeaponSystemPlugin : ModuleRules
 			new[]
 			{
 				"CoreUObject",
-				"Engine"
+				"Engine",
+				"PhysicsCore"
 			}
 		);
 
@@ -1,10 +1,33 @@
 ﻿#include "Logging/StructuredLog.h"
 
+#include "BallisticImpactSubsystem.h"
 #include "BallisticWeaponComponentDelegateHandler.h"
 #include "BallisticWeaponComponent.h"
+#include "DamageAggregationSubsystem.h"
+#include "HitboxBVHSubsystem.h"
+#include "HitScanBatchSubsystem.h"
+#include "InstancedTestProjectile.h"
+#include "WeaponSimulationSubsystem.h"
 #include "LogWeaponSystemTest.h"
+#include "ProjectileSimulationSubsystem.h"
+#include "ProjectileVisualsSubsystem.h"
+#include "RewindHistorySubsystem.h"
+#include "SimulatedTestProjectile.h"
+#include "SweptTestProjectile.h"
+#include "ScopedAllocationCounter.h"
 #include "TestWorldActor.h"
 #include "TestWorldSubsystem.h"
+#include "TypedActorPool.h"
+#include "WeaponRpmStatistics.h"
+
+#include "Components/BoxComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+#include "Engine/CollisionProfile.h"
+
+#include "EngineUtils.h"
+
+#include "GameFramework/DamageType.h"
 
 #include "Misc/AutomationTest.h"
 
@@ -32,6 +55,12 @@ BEGIN_DEFINE_SPEC(FBallisticWeaponComponent_Spec, "WeaponSystemPlugin.Runtime.Ba
 		decltype(UBallisticWeaponComponent::ShotsFiredDuringBurstFire) ShotsFiredDuringBurstFire;
 		decltype(UBallisticWeaponComponent::SecondsToReload) SecondsToReload;
 		decltype(UBallisticWeaponComponent::AmmoType) AmmoType;
+		decltype(UBallisticWeaponComponent::UseSimulationSubsystem) UseSimulationSubsystem;
+		decltype(UBallisticWeaponComponent::UseBatchedHitScan) UseBatchedHitScan;
+		decltype(UBallisticWeaponComponent::UseDamageAggregation) UseDamageAggregation;
+		decltype(UBallisticWeaponComponent::UseHitboxes) UseHitboxes;
+		decltype(UBallisticWeaponComponent::UseServerRewind) UseServerRewind;
+		decltype(UBallisticWeaponComponent::RewindLatency) RewindLatency;
 
 		FComponentOptions()
 		{
@@ -50,6 +79,12 @@ BEGIN_DEFINE_SPEC(FBallisticWeaponComponent_Spec, "WeaponSystemPlugin.Runtime.Ba
 			ShotsFiredDuringBurstFire = CDO->ShotsFiredDuringBurstFire;
 			SecondsToReload = CDO->SecondsToReload;
 			AmmoType = CDO->AmmoType;
+			UseSimulationSubsystem = CDO->UseSimulationSubsystem;
+			UseBatchedHitScan = CDO->UseBatchedHitScan;
+			UseDamageAggregation = CDO->UseDamageAggregation;
+			UseHitboxes = CDO->UseHitboxes;
+			UseServerRewind = CDO->UseServerRewind;
+			RewindLatency = CDO->RewindLatency;
 		}
 	};
 
@@ -76,12 +111,35 @@ BEGIN_DEFINE_SPEC(FBallisticWeaponComponent_Spec, "WeaponSystemPlugin.Runtime.Ba
 		PrevComponent->ShotsFiredDuringBurstFire = Options.ShotsFiredDuringBurstFire;
 		PrevComponent->SecondsToReload = Options.SecondsToReload;
 		PrevComponent->AmmoType = Options.AmmoType;
+		PrevComponent->UseSimulationSubsystem = Options.UseSimulationSubsystem;
+		PrevComponent->UseBatchedHitScan = Options.UseBatchedHitScan;
+		PrevComponent->UseDamageAggregation = Options.UseDamageAggregation;
+		PrevComponent->UseHitboxes = Options.UseHitboxes;
+		PrevComponent->UseServerRewind = Options.UseServerRewind;
+		PrevComponent->RewindLatency = Options.RewindLatency;
 
 		Actor->FinishAddComponent(PrevComponent, false, FTransform::Identity);
 		DelegateHandler->Register(PrevComponent);
 		return PrevComponent;
 	}
 
+	// Spawns a target in front of the muzzle, that counts the hits received with UDamageType.
+	AWeaponRpmStatistics* SpawnTarget(int32 ExpectedRpm, const FVector& Location = FVector(50, 0, 0))
+	{
+		auto* Statistics = World->SpawnActor<AWeaponRpmStatistics>();
+		auto* Target = NewObject<UBoxComponent>(Statistics);
+		Target->SetBoxExtent(FVector(10));
+		Target->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Statistics->SetRootComponent(Target);
+		Target->RegisterComponent();
+		Target->SetWorldLocation(Location);
+		Statistics->ExpectedDamageTypeClass = UDamageType::StaticClass();
+		Statistics->ExpectedRpm = ExpectedRpm;
+		Statistics->SecondsToSample = 60 * 60;
+		Statistics->DumpCsvOnCompletion = false;
+		return Statistics;
+	}
+
 END_DEFINE_SPEC(FBallisticWeaponComponent_Spec)
 
 void FBallisticWeaponComponent_Spec::Define()
@@ -139,6 +197,14 @@ void FBallisticWeaponComponent_Spec::Define()
 				const auto* Component = CreateAndAttachComponent(Opt);
 				TestTrueExpr(Component->GetStatus() == EBallisticWeaponStatus::Ready);
 			});
+
+			It("Shouldnt tick while idle", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				const auto* Component = CreateAndAttachComponent(Opt);
+				TestTrueExpr(!Component->IsComponentTickEnabled());
+			});
 		});
 
 		Describe("When trying to fire once", [this]
@@ -258,6 +324,97 @@ void FBallisticWeaponComponent_Spec::Define()
 				World.Tick();
 				TestTrueExpr(DelegateHandler->OnShotFiredCounter == 3);
 			});
+
+			It("Shouldnt allocate memory while firing hit-scan rounds, once warmed up", [this]
+			{
+				FComponentOptions Opt;
+				Opt.FireRateRpm = 600;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				const double WaitingTimeBetweenEachShot = Component->GetSecondsBetweenShots() + 0.1;
+				Component->FireOnce();
+				World.Tick(WaitingTimeBetweenEachShot);
+
+				constexpr int32 ShotsToFire = 10;
+				int64 Allocations = 0;
+				for (int32 i = 0; i < ShotsToFire; ++i)
+				{
+					{
+						FScopedAllocationCounter Counter;
+						Component->FireOnce();
+						Allocations += Counter.GetAllocations();
+					}
+					World.Tick(WaitingTimeBetweenEachShot);
+				}
+				TestTrueExpr(DelegateHandler->OnShotFiredCounter == ShotsToFire + 1);
+				TestTrueExpr(Allocations == 0);
+			});
+
+			It("Shouldnt allocate memory while firing projectile rounds, once warmed up", [this]
+			{
+				FComponentOptions Opt;
+				Opt.FireRateRpm = 600;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = ASimulatedTestProjectile::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				// 10000 cm/s, every round hits the target before the next one is fired
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(500, 0, 0));
+				const double WaitingTimeBetweenEachShot = Component->GetSecondsBetweenShots() + 0.1;
+				Component->FireOnce();
+				World.Tick(WaitingTimeBetweenEachShot);
+
+				constexpr int32 ShotsToFire = 10;
+				int64 Allocations = 0;
+				for (int32 i = 0; i < ShotsToFire; ++i)
+				{
+					{
+						FScopedAllocationCounter Counter;
+						Component->FireOnce();
+						Allocations += Counter.GetAllocations();
+					}
+					World.Tick(WaitingTimeBetweenEachShot);
+				}
+				TestTrueExpr(Statistics->TotalHits == ShotsToFire + 1);
+				TestTrueExpr(Allocations == 0);
+				Statistics->Destroy();
+			});
+
+			It("Shouldnt allocate memory while firing multiple scheduled shots each tick, once warmed up", [this]
+			{
+				FComponentOptions Opt;
+				Opt.FireRateRpm = 6000;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->SetFiringStrategy(EBallisticWeaponFiringStrategy::TimestampIntegerBased);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				// 10 shots are due every tick
+				const float DeltaTime = Component->GetSecondsBetweenShots() * 10;
+				Component->StartFiring();
+				World.Tick(DeltaTime);
+
+				// The World advances the clock, the weapon is updated by hand so only its own work is counted
+				constexpr int32 TicksToFire = 10;
+				int64 Allocations = 0;
+				for (int32 i = 0; i < TicksToFire; ++i)
+				{
+					Component->SetComponentTickEnabled(false);
+					World.Tick(DeltaTime);
+					{
+						FScopedAllocationCounter Counter;
+						Component->TickComponent(DeltaTime, LEVELTICK_All, &Component->PrimaryComponentTick);
+						Allocations += Counter.GetAllocations();
+					}
+				}
+				Component->StopFiring();
+				// More than one shot each tick
+				TestTrueExpr(Statistics->TotalHits > TicksToFire * 2);
+				TestTrueExpr(Allocations == 0);
+				Statistics->Destroy();
+			});
 		});
 
 		Describe("When reloading", [this]
@@ -577,6 +734,1234 @@ void FBallisticWeaponComponent_Spec::Define()
 						&& DelegateHandler->OnFiringStoppedCounter == 1
 						&& DelegateHandler->OnReloadRequestedCounter == 1);
 				});
+
+				It("Will stop firing if the rounds left in the magazine arent enough for a shot", [this]
+				{
+					FComponentOptions Opt;
+					Opt.CurrentMagazine = 3;
+					Opt.AmmoUsedEachShot = 2;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.FireRateRpm = 600;
+					auto* Component = CreateAndAttachComponent(Opt);
+					Component->StartFiring();
+					World.Tick(Component->GetSecondsBetweenShots() + 0.1);
+					TestTrueExpr(Component->CurrentMagazine == 1
+						&& Component->GetStatus() == EBallisticWeaponStatus::WaitingReload
+						&& DelegateHandler->OnShotFiredCounter == 1
+						&& DelegateHandler->OnFiringStoppedCounter == 1
+						&& DelegateHandler->OnReloadRequestedCounter == 1);
+				});
+
+				It("Will fire every shot due since the previous frame, at high fire rates and low frame rates", [this]
+				{
+					FComponentOptions Opt;
+					Opt.CurrentMagazine = 200;
+					Opt.MagazineSize = 200;
+					Opt.AmmoUsedEachShot = 1;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.FireRateRpm = 3000;
+					auto* Component = CreateAndAttachComponent(Opt);
+					TestTrueExpr(Component->FiringStrategy == EBallisticWeaponFiringStrategy::TimestampWithAccumulator);
+					Component->StartFiring();
+					// 1 second at 20 FPS
+					for (int32 i = 0; i < 20; ++i)
+					{
+						World.Tick(0.05);
+					}
+					Component->StopFiring();
+					const int32 ShotsFired = Opt.CurrentMagazine - Component->CurrentMagazine;
+					TestTrueExpr(ShotsFired >= 50 && ShotsFired <= 51);
+				});
+
+				It("Will fire the shots due during a frame from where the muzzle was at their timestamp", [this]
+				{
+					struct FListener : IBallisticWeaponListener
+					{
+						TArray<FVector> Origins;
+						TArray<FVector> Directions;
+
+						virtual void OnShotsFired(UBallisticWeaponComponent& Weapon,
+						                          const FBallisticWeaponShotBatch& Batch) override
+						{
+							for (const FHitResult& Hit : Batch.Hits)
+							{
+								Origins.Add(Hit.TraceStart);
+								Directions.Add((Hit.TraceEnd - Hit.TraceStart).GetSafeNormal());
+							}
+						}
+					} Listener;
+
+					FComponentOptions Opt;
+					Opt.HasInfiniteAmmo = true;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.AmmoType.MaximumDistance = 2000;
+					Opt.FireRateRpm = 3000;
+					auto* Component = CreateAndAttachComponent(Opt);
+					TestTrueExpr(Component->FiringStrategy == EBallisticWeaponFiringStrategy::TimestampWithAccumulator);
+					Component->AddListener(&Listener);
+
+					// A wall wide enough to be hit by every shot
+					auto* Wall = SpawnTarget(Opt.FireRateRpm, FVector(1000, 0, 0));
+					CastChecked<UBoxComponent>(Wall->GetRootComponent())->SetBoxExtent(FVector(10, 2000, 2000));
+
+					Component->StartFiring();
+					// The owner strafes and turns during the frame, 5 shots are due by its end
+					const FVector FinalLocation(0, 200, 0);
+					const FRotator FinalRotation(0, 20, 0);
+					Actor->SetActorLocationAndRotation(FinalLocation, FinalRotation);
+					World.Tick(0.1);
+					Component->StopFiring();
+					Component->RemoveListener(&Listener);
+
+					TestTrueExpr(Listener.Origins.Num() >= 5);
+					bool AreShotsOrdered = true;
+					for (int32 i = 1; i < Listener.Origins.Num(); ++i)
+					{
+						AreShotsOrdered &= Listener.Origins[i].Y > Listener.Origins[i - 1].Y;
+						AreShotsOrdered &= Listener.Directions[i].Rotation().Yaw > Listener.Directions[i - 1].Rotation().Yaw;
+					}
+					TestTrueExpr(AreShotsOrdered);
+					// The first shot leaves from where firing started, the ones in between from where the owner passed by
+					TestTrueExpr(Listener.Origins[0].Equals(FVector::ZeroVector, 1));
+					TestTrueExpr(Listener.Origins.Last().Y > 0 && Listener.Origins.Last().Y <= FinalLocation.Y + 1);
+					TestTrueExpr(Listener.Origins[1].Y < FinalLocation.Y);
+					TestTrueExpr(Listener.Directions[1].Rotation().Yaw < FinalRotation.Yaw);
+					Wall->Destroy();
+				});
+
+				It("Will tick only while firing", [this]
+				{
+					FComponentOptions Opt;
+					Opt.HasInfiniteAmmo = true;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.FireRateRpm = 600;
+					auto* Component = CreateAndAttachComponent(Opt);
+					Component->StartFiring();
+					TestTrueExpr(Component->IsComponentTickEnabled());
+					World.Tick(Component->GetSecondsBetweenShots() + 0.1);
+					Component->StopFiring();
+					TestTrueExpr(!Component->IsComponentTickEnabled());
+				});
+
+				It("Will shoot until the magazine is empty, when updated by the simulation subsystem", [this]
+				{
+					FComponentOptions Opt;
+					Opt.CurrentMagazine = 5;
+					Opt.AmmoUsedEachShot = 1;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.FireRateRpm = 600;
+					Opt.UseSimulationSubsystem = true;
+					auto* Component = CreateAndAttachComponent(Opt);
+					const auto* Simulation = World->GetSubsystem<UWeaponSimulationSubsystem>();
+					double TimeToShoot = Component->GetSecondsBetweenShots() + 0.1;
+					Component->StartFiring();
+					TestTrueExpr(!Component->IsComponentTickEnabled() && Simulation->Num() == 1);
+					World.Tick(TimeToShoot);
+					World.Tick(TimeToShoot);
+					World.Tick(TimeToShoot);
+					World.Tick(TimeToShoot);
+					TestTrueExpr(Component->CurrentMagazine == 0
+						&& DelegateHandler->OnShotFiredCounter == 5
+						&& DelegateHandler->OnFiringStartedCounter == 1
+						&& DelegateHandler->OnFiringStoppedCounter == 1
+						&& DelegateHandler->OnReloadRequestedCounter == 1
+						&& Simulation->Num() == 0);
+				});
+
+				It("Wont fire a weapon destroyed earlier in the same simulation update", [this]
+				{
+					// Stands for damage dealt by the first weapon killing the owner of the second one
+					struct FDestroyOnShot : IBallisticWeaponListener
+					{
+						TObjectPtr<AActor> ActorToDestroy;
+
+						virtual void OnShotsFired(UBallisticWeaponComponent& Weapon,
+						                          const FBallisticWeaponShotBatch& Shots) override
+						{
+							if (Shots.Num() > 0 && ActorToDestroy)
+							{
+								ActorToDestroy->Destroy();
+								ActorToDestroy = nullptr;
+							}
+						}
+					} Listener;
+
+					FComponentOptions Opt;
+					Opt.MagazineSize = 10;
+					Opt.CurrentMagazine = Opt.MagazineSize;
+					Opt.AmmoUsedEachShot = 1;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.FireRateRpm = 600;
+					Opt.UseSimulationSubsystem = true;
+					auto* Component = CreateAndAttachComponent(Opt);
+
+					auto* OtherActor = World->SpawnActor<ATestWorldActor>();
+					auto* OtherComponent = NewObject<UBallisticWeaponComponent>(OtherActor);
+					OtherComponent->MagazineSize = Opt.MagazineSize;
+					OtherComponent->CurrentMagazine = Opt.CurrentMagazine;
+					OtherComponent->AmmoUsedEachShot = Opt.AmmoUsedEachShot;
+					OtherComponent->AmmoType = Opt.AmmoType;
+					OtherComponent->FireRateRpm = Opt.FireRateRpm;
+					OtherComponent->UseSimulationSubsystem = true;
+					OtherActor->FinishAddComponent(OtherComponent, false, FTransform::Identity);
+
+					const auto* Simulation = World->GetSubsystem<UWeaponSimulationSubsystem>();
+					Component->StartFiring();
+					OtherComponent->StartFiring();
+					TestTrueExpr(Simulation->Num() == 2);
+
+					Listener.ActorToDestroy = OtherActor;
+					Component->AddListener(&Listener);
+					World.Tick(Component->GetSecondsBetweenShots() + 0.01);
+					Component->RemoveListener(&Listener);
+					Component->StopFiring();
+
+					TestTrueExpr(Component->CurrentMagazine == Opt.CurrentMagazine - 2);
+					TestTrueExpr(OtherComponent->CurrentMagazine == Opt.CurrentMagazine - 1);
+					TestTrueExpr(Simulation->Num() == 0);
+				});
+			});
+		});
+
+		Describe("When batching hit-scan shots", [this]
+		{
+			It("Should apply the damage once the batch is resolved", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.UseBatchedHitScan = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				const auto* Batch = World->GetSubsystem<UHitScanBatchSubsystem>();
+
+				Component->FireOnce();
+				TestTrueExpr(Batch->Num() == 1 && Statistics->TotalHits == 0);
+				World.Tick();
+				TestTrueExpr(Batch->Num() == 0 && Statistics->TotalHits == 1);
+				Statistics->Destroy();
+			});
+
+			It("Should hit as many times as the weapon fires", [this]
+			{
+				FComponentOptions Opt;
+				Opt.CurrentMagazine = 200;
+				Opt.MagazineSize = 200;
+				Opt.AmmoUsedEachShot = 1;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = 3000;
+				Opt.UseBatchedHitScan = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+
+				Component->StartFiring();
+				for (int32 i = 0; i < 20; ++i)
+				{
+					World.Tick(0.05);
+				}
+				Component->StopFiring();
+				World.Tick();
+				const int32 ShotsFired = Opt.CurrentMagazine - Component->CurrentMagazine;
+				TestTrueExpr(ShotsFired > 1 && Statistics->TotalHits == ShotsFired);
+				Statistics->Destroy();
+			});
+
+			It("Should resolve the shots fired by the simulation subsystem in the same frame", [this]
+			{
+				FComponentOptions Opt;
+				Opt.CurrentMagazine = 200;
+				Opt.MagazineSize = 200;
+				Opt.AmmoUsedEachShot = 1;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = 3000;
+				Opt.UseBatchedHitScan = true;
+				Opt.UseSimulationSubsystem = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				const auto* Batch = World->GetSubsystem<UHitScanBatchSubsystem>();
+
+				Component->StartFiring();
+				bool IsResolvedEachFrame = true;
+				for (int32 i = 0; i < 10; ++i)
+				{
+					World.Tick(0.05);
+					const int32 ShotsFired = Opt.CurrentMagazine - Component->CurrentMagazine;
+					IsResolvedEachFrame &= Batch->Num() == 0 && Statistics->TotalHits == ShotsFired;
+				}
+				Component->StopFiring();
+				TestTrueExpr(Statistics->TotalHits > 10);
+				TestTrueExpr(IsResolvedEachFrame);
+				Statistics->Destroy();
+			});
+
+			It("Should keep the shots fired while the batch is being resolved", [this]
+			{
+				// Stands for a weapon fired in reaction to a hit, like from TakeDamage
+				struct FFireOnHit : IBallisticWeaponListener
+				{
+					UHitScanBatchSubsystem* Batch = nullptr;
+					bool HasFired = false;
+
+					virtual void OnShotsFired(UBallisticWeaponComponent& Weapon,
+					                          const FBallisticWeaponShotBatch& Shots) override
+					{
+						if (!HasFired && !Shots.Hits.IsEmpty())
+						{
+							HasFired = true;
+							Batch->Enqueue(&Weapon, {0, FVector::ZeroVector, FVector::ForwardVector});
+						}
+					}
+				} Listener;
+
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.UseBatchedHitScan = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				auto* Batch = World->GetSubsystem<UHitScanBatchSubsystem>();
+				Listener.Batch = Batch;
+				Component->AddListener(&Listener);
+
+				Component->FireOnce();
+				Batch->Flush();
+				TestTrueExpr(Listener.HasFired && Batch->Num() == 1 && Statistics->TotalHits == 1);
+				Batch->Flush();
+				TestTrueExpr(Batch->Num() == 0 && Statistics->TotalHits == 2);
+				Component->RemoveListener(&Listener);
+				Statistics->Destroy();
+			});
+		});
+
+		Describe("When hit-scan rounds penetrate", [this]
+		{
+			It("Should go through layers until the penetration budget is spent", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.PenetrationBudget = 1;
+				Opt.AmmoType.DefaultPenetrationCost = 1;
+				auto* Component = CreateAndAttachComponent(Opt);
+				TArray<AWeaponRpmStatistics*> Targets{
+					SpawnTarget(Opt.FireRateRpm, FVector(30, 0, 0)),
+					SpawnTarget(Opt.FireRateRpm, FVector(60, 0, 0)),
+					SpawnTarget(Opt.FireRateRpm, FVector(90, 0, 0)),
+				};
+
+				Component->FireOnce();
+				TestTrueExpr(Targets[0]->TotalHits == 1 && Targets[1]->TotalHits == 1 && Targets[2]->TotalHits == 0);
+				for (AWeaponRpmStatistics* Target : Targets)
+				{
+					Target->Destroy();
+				}
+			});
+
+			It("Shouldnt go through more than the maximum amount of layers", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.PenetrationBudget = 10;
+				Opt.AmmoType.MaxPenetratedLayers = 0;
+				auto* Component = CreateAndAttachComponent(Opt);
+				TArray<AWeaponRpmStatistics*> Targets{
+					SpawnTarget(Opt.FireRateRpm, FVector(30, 0, 0)),
+					SpawnTarget(Opt.FireRateRpm, FVector(60, 0, 0)),
+				};
+
+				Component->FireOnce();
+				TestTrueExpr(Targets[0]->TotalHits == 1 && Targets[1]->TotalHits == 0);
+				for (AWeaponRpmStatistics* Target : Targets)
+				{
+					Target->Destroy();
+				}
+			});
+
+			It("Shouldnt trace past the range the penetration budget can carry the round", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.PenetrationBudget = 10;
+				Opt.AmmoType.PenetrationRangePerBudget = 5;
+				auto* Component = CreateAndAttachComponent(Opt);
+				TArray<AWeaponRpmStatistics*> Targets{
+					SpawnTarget(Opt.FireRateRpm, FVector(30, 0, 0)),
+					SpawnTarget(Opt.FireRateRpm, FVector(90, 0, 0)),
+				};
+
+				Component->FireOnce();
+				TestTrueExpr(Targets[0]->TotalHits == 1 && Targets[1]->TotalHits == 0);
+				for (AWeaponRpmStatistics* Target : Targets)
+				{
+					Target->Destroy();
+				}
+			});
+		});
+
+		Describe("When firing multiple pellets", [this]
+		{
+			It("Should damage a target once per shot, no matter how many pellets hit it", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.PelletCount = 12;
+				Opt.AmmoType.SpreadHalfAngle = 2;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+
+				Component->FireOnce();
+				TestTrueExpr(Statistics->TotalHits == 1);
+				Statistics->Destroy();
+			});
+
+			It("Should damage a target once per shot when batching the pellets", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.UseBatchedHitScan = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.PelletCount = 12;
+				Opt.AmmoType.SpreadHalfAngle = 2;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				const auto* Batch = World->GetSubsystem<UHitScanBatchSubsystem>();
+
+				Component->FireOnce();
+				TestTrueExpr(Batch->Num() == Opt.AmmoType.PelletCount);
+				World.Tick();
+				TestTrueExpr(Statistics->TotalHits == 1);
+				Statistics->Destroy();
+			});
+
+			It("Should spread the pellets within the cone", [this]
+			{
+				FAmmoType AmmoType;
+				AmmoType.PelletCount = 64;
+				AmmoType.SpreadHalfAngle = 10;
+				FRandomStream Stream(42);
+				TArray<FVector> Directions;
+				Directions.SetNumZeroed(AmmoType.PelletCount);
+				AmmoType.GeneratePelletDirections(FVector::ForwardVector, Stream, Directions);
+
+				const double MinCos = FMath::Cos(FMath::DegreesToRadians(AmmoType.SpreadHalfAngle)) - UE_KINDA_SMALL_NUMBER;
+				bool AllInsideCone = true;
+				for (const FVector& Direction : Directions)
+				{
+					AllInsideCone &= Direction.IsNormalized() && (Direction | FVector::ForwardVector) >= MinCos;
+				}
+				TestTrueExpr(AllInsideCone);
+				TestTrueExpr(!Directions[0].Equals(Directions[1]));
+			});
+
+			It("Should generate the same pellets from the same seed", [this]
+			{
+				FAmmoType AmmoType;
+				AmmoType.PelletCount = 12;
+				AmmoType.SpreadHalfAngle = 5;
+				FRandomStream FirstStream(42);
+				FRandomStream SecondStream(42);
+				TArray<FVector> FirstDirections, SecondDirections;
+				FirstDirections.SetNumZeroed(AmmoType.PelletCount);
+				SecondDirections.SetNumZeroed(AmmoType.PelletCount);
+				AmmoType.GeneratePelletDirections(FVector::ForwardVector, FirstStream, FirstDirections);
+				AmmoType.GeneratePelletDirections(FVector::ForwardVector, SecondStream, SecondDirections);
+				TestTrueExpr(FirstDirections == SecondDirections);
+			});
+		});
+
+		Describe("When aggregating damage", [this]
+		{
+			It("Should damage a target once per frame, keeping the count of hits", [this]
+			{
+				FComponentOptions Opt;
+				Opt.FireRateRpm = 3000;
+				Opt.MagazineSize = 100;
+				Opt.CurrentMagazine = Opt.MagazineSize;
+				Opt.AmmoUsedEachShot = 1;
+				Opt.UseDamageAggregation = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				const auto* DamageAggregation = World->GetSubsystem<UDamageAggregationSubsystem>();
+
+				Component->StartFiring();
+				for (int32 i = 0; i < 20; ++i)
+				{
+					World.Tick(0.05);
+				}
+				Component->StopFiring();
+				World.Tick();
+				const int32 ShotsFired = Opt.CurrentMagazine - Component->CurrentMagazine;
+				TestTrueExpr(ShotsFired > 20 && Statistics->TotalHits == ShotsFired);
+				TestTrueExpr(DamageAggregation->Num() == 0);
+				Statistics->Destroy();
+			});
+
+			It("Should keep the count of the pellets that hit a target", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.UseDamageAggregation = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.PelletCount = 12;
+				Opt.AmmoType.SpreadHalfAngle = 2;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				const auto* DamageAggregation = World->GetSubsystem<UDamageAggregationSubsystem>();
+
+				Component->FireOnce();
+				TestTrueExpr(DamageAggregation->Num() == 1 && Statistics->TotalHits == 0);
+				World.Tick();
+				TestTrueExpr(DamageAggregation->Num() == 0 && Statistics->TotalHits == Opt.AmmoType.PelletCount);
+				Statistics->Destroy();
+			});
+
+			It("Should sum the damage queued for the same target", [this]
+			{
+				auto* DamageAggregation = World->GetSubsystem<UDamageAggregationSubsystem>();
+				auto* Statistics = SpawnTarget(600);
+				for (int32 i = 0; i < 3; ++i)
+				{
+					DamageAggregation->QueueDamage(Statistics, 10, UDamageType::StaticClass(), nullptr, Actor);
+				}
+				TestTrueExpr(DamageAggregation->Num() == 1);
+				DamageAggregation->Flush();
+				TestTrueExpr(DamageAggregation->Num() == 0 && Statistics->TotalHits == 3);
+				Statistics->Destroy();
+			});
+		});
+
+		Describe("When simulating projectiles without Actors", [this]
+		{
+			It("Should hit the target without spawning any projectile", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = ASimulatedTestProjectile::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(500, 0, 0));
+				const auto* ProjectileSimulation = World->GetSubsystem<UProjectileSimulationSubsystem>();
+
+				Component->FireOnce();
+				TestTrueExpr(ProjectileSimulation->Num() == 1);
+				// 10000 cm/s, the target is hit within 5 frames
+				for (int32 i = 0; i < 5; ++i)
+				{
+					World.Tick(0.016);
+				}
+				TestTrueExpr(Statistics->TotalHits == 1);
+				TestTrueExpr(ProjectileSimulation->Num() == 0);
+				TestTrueExpr(!TActorIterator<AProjectileBase>(World->GetWorld()));
+				Statistics->Destroy();
+			});
+
+			It("Should drop the rounds that hit nothing once their lifetime is over", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = ASimulatedTestProjectile::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				const auto* ProjectileSimulation = World->GetSubsystem<UProjectileSimulationSubsystem>();
+
+				Component->FireOnce();
+				World.Tick(0.5);
+				TestTrueExpr(ProjectileSimulation->Num() == 1);
+				World.Tick(0.6);
+				TestTrueExpr(ProjectileSimulation->Num() == 0);
+			});
+
+			It("Should spawn an Actor for rounds that use the proximity fuse", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = ASimulatedTestProjectile::StaticClass();
+				auto* Archetype = GetMutableDefault<ASimulatedTestProjectile>();
+				Archetype->ProximityFuseRadius = 50;
+				auto* Component = CreateAndAttachComponent(Opt);
+				const auto* ProjectileSimulation = World->GetSubsystem<UProjectileSimulationSubsystem>();
+
+				Component->FireOnce();
+				Archetype->ProximityFuseRadius = 0;
+				TestTrueExpr(ProjectileSimulation->Num() == 0);
+				TActorIterator<ASimulatedTestProjectile> Projectile(World->GetWorld());
+				TestTrueExpr(Projectile && Projectile->ProximityFuseRadius == 50);
+				for (; Projectile; ++Projectile)
+				{
+					Projectile->Destroy();
+				}
+			});
+		});
+
+		Describe("When drawing projectiles as instances", [this]
+		{
+			It("Should draw one instance per projectile in flight", [this]
+			{
+				FComponentOptions Opt;
+				Opt.FireRateRpm = 600;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = AInstancedTestProjectile::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				const auto* ProjectileVisuals = World->GetSubsystem<UProjectileVisualsSubsystem>();
+
+				Component->FireOnce();
+				World.Tick(Component->GetSecondsBetweenShots() + 0.1);
+				Component->FireOnce();
+				World.Tick();
+				TestTrueExpr(ProjectileVisuals->Num() == 2);
+
+				const UInstancedStaticMeshComponent* Instances =
+					ProjectileVisuals->GetInstancedMeshComponent(AInstancedTestProjectile::StaticClass());
+				TestTrueExpr(Instances && Instances->GetInstanceCount() == 2);
+
+				bool InstancesFollowProjectiles = true;
+				int32 ProjectilesInFlight = 0;
+				for (TActorIterator<AInstancedTestProjectile> It(World->GetWorld()); It; ++It)
+				{
+					++ProjectilesInFlight;
+					bool IsDrawn = false;
+					for (int32 Index = 0; Index < Instances->GetInstanceCount(); ++Index)
+					{
+						FTransform InstanceTransform;
+						Instances->GetInstanceTransform(Index, InstanceTransform, true);
+						IsDrawn |= InstanceTransform.GetLocation().Equals(It->GetActorLocation());
+					}
+					InstancesFollowProjectiles &= IsDrawn && !It->ProjectileMeshComponent->IsVisible();
+				}
+				TestTrueExpr(ProjectilesInFlight == 2 && InstancesFollowProjectiles);
+
+				for (TActorIterator<AInstancedTestProjectile> It(World->GetWorld()); It; ++It)
+				{
+					TActorPool<AProjectileBase>(World->GetWorld(), AInstancedTestProjectile::StaticClass()).Release(*It);
+				}
+				World.Tick();
+				TestTrueExpr(ProjectileVisuals->Num() == 0 && Instances->GetInstanceCount() == 0);
+			});
+
+			It("Should draw a prewarmed projectile only once acquired", [this]
+			{
+				const auto* ProjectileVisuals = World->GetSubsystem<UProjectileVisualsSubsystem>();
+				TActorPool<AProjectileBase> Pool(World->GetWorld(), AInstancedTestProjectile::StaticClass());
+				const int32 PooledProjectiles = Pool.Num();
+				Pool.Populate(2);
+				TestTrueExpr(Pool.Num() == PooledProjectiles + 2 && ProjectileVisuals->Num() == 0);
+
+				AProjectileBase* Projectile = Pool.Acquire();
+				TestTrueExpr(ProjectileVisuals->Num() == 1 && !Projectile->IsHidden());
+
+				Pool.Release(Projectile);
+				TestTrueExpr(ProjectileVisuals->Num() == 0 && Projectile->IsHidden());
+			});
+		});
+
+		Describe("When projectiles use swept collision", [this]
+		{
+			It("Shouldnt tunnel through a target they fly past in a single tick", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = ASweptTestProjectile::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(300, 0, 0));
+
+				Component->FireOnce();
+				// 5000 cm each tick, the target is 20 cm thick
+				World.Tick(0.05);
+				World.Tick(0.05);
+				TestTrueExpr(Statistics->TotalHits == 1);
+				Statistics->Destroy();
+			});
+		});
+
+		Describe("When only some rounds are tracers", [this]
+		{
+			It("Should spawn an Actor only for the tracers, and hit with every round", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = false;
+				Opt.AmmoType.ProjectileClass = ASweptTestProjectile::StaticClass();
+				Opt.AmmoType.PelletCount = 8;
+				Opt.AmmoType.TracerEveryNthRound = 4;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(3000, 0, 0));
+				const auto* ProjectileSimulation = World->GetSubsystem<UProjectileSimulationSubsystem>();
+
+				Component->FireOnce();
+				int32 TracersInFlight = 0;
+				for (TActorIterator<ASweptTestProjectile> It(World->GetWorld()); It; ++It)
+				{
+					TracersInFlight += !It->IsHidden();
+				}
+				TestTrueExpr(TracersInFlight == 2 && ProjectileSimulation->Num() == 6);
+
+				World.Tick(0.05);
+				World.Tick(0.05);
+				TestTrueExpr(Statistics->TotalHits == 8);
+				Statistics->Destroy();
+			});
+		});
+
+		Describe("When hit-scan rounds follow a ballistic trajectory", [this]
+		{
+			It("Should damage the target after the flight time", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.UseBallisticTrajectory = true;
+				Opt.AmmoType.BallisticGravityScale = 0;
+				Opt.AmmoType.MuzzleSpeed = 1000;
+				Opt.AmmoType.MaximumDistance = 5000;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(510, 0, 0));
+				const auto* BallisticImpacts = World->GetSubsystem<UBallisticImpactSubsystem>();
+
+				Component->FireOnce();
+				TestTrueExpr(BallisticImpacts->Num() == 1);
+				World.Tick(0.3);
+				TestTrueExpr(Statistics->TotalHits == 0);
+				World.Tick(0.3);
+				TestTrueExpr(Statistics->TotalHits == 1 && BallisticImpacts->Num() == 0);
+				Statistics->Destroy();
+			});
+
+			It("Shouldnt hit past the maximum distance, within the last segment", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.UseBallisticTrajectory = true;
+				Opt.AmmoType.BallisticGravityScale = 0;
+				Opt.AmmoType.MuzzleSpeed = 1000;
+				Opt.AmmoType.BallisticTraceSegments = 1;
+				Opt.AmmoType.MaximumDistance = 500;
+				auto* Component = CreateAndAttachComponent(Opt);
+				// A single segment spans the whole flight, well past MaximumDistance
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(710, 0, 0));
+				const auto* BallisticImpacts = World->GetSubsystem<UBallisticImpactSubsystem>();
+
+				Component->FireOnce();
+				TestTrueExpr(BallisticImpacts->Num() == 0);
+				World.Tick(1);
+				TestTrueExpr(Statistics->TotalHits == 0);
+				Statistics->Destroy();
+			});
+
+			It("Should drop under gravity", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.UseBallisticTrajectory = true;
+				Opt.AmmoType.MuzzleSpeed = 1000;
+				Opt.AmmoType.MaximumDistance = 5000;
+				auto* Component = CreateAndAttachComponent(Opt);
+				// The face of the target is where the round is after one second
+				const double Drop = 0.5 * World->GetGravityZ();
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm, FVector(1010, 0, Drop));
+
+				Component->FireOnce();
+				World.Tick(1.1);
+				TestTrueExpr(Statistics->TotalHits == 1);
+				Statistics->Destroy();
+			});
+		});
+
+		Describe("When testing hit-scan rounds against hitboxes", [this]
+		{
+			// Only the hitbox can be hit, the target doesn't collide
+			auto SpawnHitboxTarget = [this](int32 ExpectedRpm, const FVector& Location)
+			{
+				auto* Statistics = SpawnTarget(ExpectedRpm, Location);
+				Statistics->SetActorEnableCollision(false);
+				auto* Hitbox = NewObject<UHitboxComponent>(Statistics);
+				Hitbox->Shapes.AddDefaulted_GetRef().Radius = 20;
+				Hitbox->RegisterComponent();
+				World->GetSubsystem<UHitboxBVHSubsystem>()->Refresh();
+				return Statistics;
+			};
+
+			It("Should damage the Actor owning the hitbox", [this, SpawnHitboxTarget]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.UseHitboxes = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnHitboxTarget(Opt.FireRateRpm, FVector(200, 0, 0));
+
+				Component->FireOnce();
+				TestTrueExpr(Statistics->TotalHits == 1);
+				Statistics->Destroy();
+			});
+
+			It("Should stop at the world geometry in front of the hitbox", [this, SpawnHitboxTarget]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.UseHitboxes = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnHitboxTarget(Opt.FireRateRpm, FVector(200, 0, 0));
+				auto* Wall = SpawnTarget(Opt.FireRateRpm, FVector(100, 0, 0));
+
+				Component->FireOnce();
+				TestTrueExpr(Statistics->TotalHits == 0 && Wall->TotalHits == 1);
+				Statistics->Destroy();
+				Wall->Destroy();
+			});
+
+			It("Should penetrate the hitboxes and the world geometry as layers", [this, SpawnHitboxTarget]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.AmmoType.MaximumDistance = 1000;
+				Opt.AmmoType.PenetrationBudget = 2;
+				Opt.AmmoType.DefaultPenetrationCost = 1;
+				Opt.UseHitboxes = true;
+				auto* Component = CreateAndAttachComponent(Opt);
+				TArray<AWeaponRpmStatistics*> Targets{
+					SpawnHitboxTarget(Opt.FireRateRpm, FVector(100, 0, 0)),
+					SpawnTarget(Opt.FireRateRpm, FVector(200, 0, 0)),
+					SpawnHitboxTarget(Opt.FireRateRpm, FVector(300, 0, 0)),
+					SpawnHitboxTarget(Opt.FireRateRpm, FVector(400, 0, 0)),
+				};
+
+				Component->FireOnce();
+				TestTrueExpr(Targets[0]->TotalHits == 1 && Targets[1]->TotalHits == 1 && Targets[2]->TotalHits == 1);
+				TestTrueExpr(Targets[3]->TotalHits == 0);
+				for (AWeaponRpmStatistics* Target : Targets)
+				{
+					Target->Destroy();
+				}
+			});
+		});
+
+		Describe("When rewinding the targets to the shooter's latency", [this]
+		{
+			It("Should hit the targets where the shooter saw them", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.UseServerRewind = true;
+				Opt.RewindLatency = 0.2f;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				auto* History = World->GetSubsystem<URewindHistorySubsystem>();
+				History->Register(Statistics);
+
+				// In front of the muzzle 0.2s ago, out of the line of fire now
+				const double Now = World->GetTimeSeconds();
+				History->Record(Now - Opt.RewindLatency);
+				Statistics->SetActorLocation(FVector(50, 500, 0));
+				History->Record(Now);
+
+				Component->FireOnce();
+				TestTrueExpr(Statistics->TotalHits == 1);
+				TestTrueExpr(Statistics->GetActorLocation().Equals(FVector(50, 500, 0)));
+				History->Unregister(Statistics);
+				Statistics->Destroy();
+			});
+
+			It("Should rewind the targets once for all the shots fired during a frame", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = 6000;
+				Opt.UseServerRewind = true;
+				Opt.RewindLatency = 1.f;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->SetFiringStrategy(EBallisticWeaponFiringStrategy::TimestampIntegerBased);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				auto* History = World->GetSubsystem<URewindHistorySubsystem>();
+				History->Register(Statistics);
+
+				// In front of the muzzle until half a second ago, out of the line of fire since then
+				const double Now = World->GetTimeSeconds();
+				History->Record(Now - 10);
+				History->Record(Now - 0.5);
+				Statistics->SetActorLocation(FVector(50, 500, 0));
+				History->Record(Now);
+
+				// 10 shots are due during the frame
+				Component->StartFiring();
+				World.Tick(Component->GetSecondsBetweenShots() * 10);
+				Component->StopFiring();
+
+				// Each shot is still damaged on its own, once the target has been put back
+				TestTrueExpr(Statistics->TotalHits >= 10);
+				TestTrueExpr(!History->IsRewinding());
+				TestTrueExpr(Statistics->GetActorLocation().Equals(FVector(50, 500, 0)));
+				History->Unregister(Statistics);
+				Statistics->Destroy();
+			});
+
+			It("Should hit the targets where the shooter saw them, when batched", [this]
+			{
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.UseBatchedHitScan = true;
+				Opt.UseServerRewind = true;
+				Opt.RewindLatency = 1.f;
+				auto* Component = CreateAndAttachComponent(Opt);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				auto* History = World->GetSubsystem<URewindHistorySubsystem>();
+				History->Register(Statistics);
+
+				const double Now = World->GetTimeSeconds();
+				History->Record(Now - 10);
+				History->Record(Now - 0.5);
+				Statistics->SetActorLocation(FVector(50, 500, 0));
+				History->Record(Now);
+
+				Component->FireOnce();
+				TestTrueExpr(Statistics->TotalHits == 0);
+				// Traced at the end of the frame, rewound to one second before it
+				World.Tick(0.01);
+				TestTrueExpr(Statistics->TotalHits == 1);
+				TestTrueExpr(!History->IsRewinding());
+				History->Unregister(Statistics);
+				Statistics->Destroy();
+			});
+		});
+
+		Describe("When using the integer-based firing strategy", [this]
+		{
+			It("Shouldnt drift over hours of firing", [this]
+			{
+				constexpr int32 FireRateRpm = 700;
+				constexpr int32 SecondsToFire = 2 * 60 * 60;
+				FComponentOptions Opt;
+				Opt.MagazineSize = 100000;
+				Opt.CurrentMagazine = Opt.MagazineSize;
+				Opt.AmmoUsedEachShot = 1;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = FireRateRpm;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->SetFiringStrategy(EBallisticWeaponFiringStrategy::TimestampIntegerBased);
+
+				auto* Statistics = SpawnTarget(FireRateRpm);
+				Statistics->SecondsToSample = SecondsToFire;
+				Statistics->TakeSnapshots = true;
+				Statistics->SecondsBetweenSnapshots = 10 * 60;
+
+				Component->StartFiring();
+				for (int32 i = 0; i < SecondsToFire; ++i)
+				{
+					World.Tick(1);
+				}
+				// Half a shot away from the closest shot, so rounding can't change the expected count
+				World.Tick(0.5);
+				Component->StopFiring();
+
+				const int32 ShotsFired = Opt.CurrentMagazine - Component->CurrentMagazine;
+				TestTrueExpr(ShotsFired == 1 + FMath::FloorToInt32((SecondsToFire + 0.5) * FireRateRpm / 60));
+				TestTrueExpr(!Statistics->Snapshots.IsEmpty());
+				for (const FRpmSnapshot& Snapshot : Statistics->Snapshots)
+				{
+					TestTrueExpr(FMath::Abs(Snapshot.Drift) <= 1.0);
+				}
+				Statistics->Destroy();
+			});
+
+			It("Should fire exactly the shots due with an irregular frame rate", [this]
+			{
+				constexpr int32 FireRateRpm = 700;
+				constexpr double SecondsToFire = 10 * 60;
+				constexpr int64 NanosecondsPerMinute = 60'000'000'000;
+
+				// Shots fired and shots due by the World clock, which is what the weapon reads
+				auto FireWithIrregularFrames = [this](EBallisticWeaponFiringStrategy Strategy, int64& OutExpectedShots)
+				{
+					FComponentOptions Opt;
+					Opt.MagazineSize = 100000;
+					Opt.CurrentMagazine = Opt.MagazineSize;
+					Opt.AmmoUsedEachShot = 1;
+					Opt.AmmoType.IsHitScan = true;
+					Opt.FireRateRpm = FireRateRpm;
+					auto* Component = CreateAndAttachComponent(Opt);
+					Component->SetFiringStrategy(Strategy);
+
+					// Same seed for every strategy, so they all see the same frames
+					FRandomStream Frames(33);
+					const double StartSeconds = World->TimeSeconds;
+					Component->StartFiring();
+					while (World->TimeSeconds - StartSeconds < SecondsToFire)
+					{
+						World.Tick(Frames.FRandRange(1.f / 144, 1.f / 20));
+					}
+					const double EndSeconds = World->TimeSeconds;
+					Component->StopFiring();
+
+					// Shot N is due at N * 60s / FireRateRpm, rounded down to the nanosecond
+					const int64 ElapsedNs = FMath::FloorToInt64(EndSeconds * 1e9) - FMath::FloorToInt64(StartSeconds * 1e9);
+					OutExpectedShots = ((ElapsedNs + 1) * FireRateRpm + NanosecondsPerMinute - 1) / NanosecondsPerMinute;
+					return static_cast<int64>(Opt.CurrentMagazine - Component->CurrentMagazine);
+				};
+
+				int64 ExpectedShots;
+				const int64 IntegerShots = FireWithIrregularFrames(
+					EBallisticWeaponFiringStrategy::TimestampIntegerBased, ExpectedShots);
+				TestTrueExpr(ExpectedShots >= SecondsToFire * FireRateRpm / 60);
+				TestTrueExpr(IntegerShots == ExpectedShots);
+
+				// Rescheduling from the frame that fired loses part of a frame every shot
+				const int64 TimestampShots = FireWithIrregularFrames(EBallisticWeaponFiringStrategy::Timestamp,
+				                                                     ExpectedShots);
+				TestTrueExpr(TimestampShots < ExpectedShots * 0.95);
+
+				// Catches up within the frame, but the schedule is a running sum of doubles
+				const int64 AccumulatorShots = FireWithIrregularFrames(
+					EBallisticWeaponFiringStrategy::TimestampWithAccumulator, ExpectedShots);
+				TestTrueExpr(FMath::Abs(AccumulatorShots - ExpectedShots) <= 1);
+			});
+		});
+
+		Describe("When notifying native listeners", [this]
+		{
+			It("Should report every shot fired during a frame, with its hits", [this]
+			{
+				struct FListener : IBallisticWeaponListener
+				{
+					int32 Batches = 0;
+					int32 Shots = 0;
+					int32 Hits = 0;
+					int32 FiringStarted = 0;
+					bool AreTimestampsSorted = true;
+
+					virtual void OnFiringStarted(UBallisticWeaponComponent& Weapon) override
+					{
+						++FiringStarted;
+					}
+
+					virtual void OnShotsFired(UBallisticWeaponComponent& Weapon,
+					                          const FBallisticWeaponShotBatch& Batch) override
+					{
+						++Batches;
+						Shots += Batch.Num();
+						Hits += Batch.Hits.Num();
+						for (int32 i = 1; i < Batch.Num(); ++i)
+						{
+							AreTimestampsSorted &= Batch.Timestamps[i - 1] <= Batch.Timestamps[i];
+						}
+					}
+				} Listener;
+
+				constexpr int32 FireRateRpm = 6000;
+				FComponentOptions Opt;
+				Opt.MagazineSize = 1000;
+				Opt.CurrentMagazine = Opt.MagazineSize;
+				Opt.AmmoUsedEachShot = 1;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = FireRateRpm;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->SetFiringStrategy(EBallisticWeaponFiringStrategy::TimestampWithAccumulator);
+				Component->AddListener(&Listener);
+
+				auto* Statistics = SpawnTarget(FireRateRpm);
+
+				Component->StartFiring();
+				World.Tick(0.5);
+				Component->StopFiring();
+				Component->RemoveListener(&Listener);
+
+				const int32 ShotsFired = Opt.CurrentMagazine - Component->CurrentMagazine;
+				TestTrueExpr(ShotsFired > 2);
+				TestTrueExpr(Listener.Shots == ShotsFired);
+				TestTrueExpr(Listener.Hits == ShotsFired);
+				TestTrueExpr(Listener.Batches < ShotsFired);
+				TestTrueExpr(Listener.FiringStarted == 1);
+				TestTrueExpr(Listener.AreTimestampsSorted);
+				Statistics->Destroy();
+			});
+
+			It("Should stop notifying a removed listener", [this]
+			{
+				struct FListener : IBallisticWeaponListener
+				{
+					int32 Shots = 0;
+
+					virtual void OnShotsFired(UBallisticWeaponComponent& Weapon,
+					                          const FBallisticWeaponShotBatch& Batch) override
+					{
+						Shots += Batch.Num();
+					}
+				} Listener;
+
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = 1;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->AddListener(&Listener);
+				Component->FireOnce();
+				Component->RemoveListener(&Listener);
+				World.Tick(60);
+				Component->FireOnce();
+
+				TestTrueExpr(Listener.Shots == 1);
+				TestTrueExpr(DelegateHandler->OnShotFiredCounter == 2);
+			});
+
+			It("Shouldnt notify a listener removed by a previous one", [this]
+			{
+				struct FListener : IBallisticWeaponListener
+				{
+					IBallisticWeaponListener* ListenerToRemove = nullptr;
+					int32 Notifications = 0;
+
+					virtual void OnStatusChanged(UBallisticWeaponComponent& Weapon, EBallisticWeaponStatus Status) override
+					{
+						++Notifications;
+						if (ListenerToRemove)
+						{
+							Weapon.RemoveListener(ListenerToRemove);
+						}
+					}
+
+					virtual void OnShotsFired(UBallisticWeaponComponent& Weapon,
+					                          const FBallisticWeaponShotBatch& Batch) override
+					{
+						++Notifications;
+					}
+				};
+				FListener Remover;
+				FListener Removed;
+				Remover.ListenerToRemove = &Removed;
+
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->AddListener(&Remover);
+				Component->AddListener(&Removed);
+				Component->FireOnce();
+				Component->RemoveListener(&Remover);
+
+				TestTrueExpr(Remover.Notifications == 2);
+				TestTrueExpr(Removed.Notifications == 0);
+			});
+		});
+
+		Describe("When selecting the fire policy", [this]
+		{
+			It("Should use the ammo model set before selecting it again", [this]
+			{
+				FComponentOptions Opt;
+				Opt.MagazineSize = 10;
+				Opt.CurrentMagazine = Opt.MagazineSize;
+				Opt.AmmoUsedEachShot = 1;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = 600;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->HasInfiniteAmmo = true;
+				Component->SelectFirePolicy();
+
+				Component->StartFiring();
+				for (int32 i = 0; i < 10; ++i)
+				{
+					World.Tick(0.1);
+				}
+				Component->StopFiring();
+
+				TestTrueExpr(Component->CurrentMagazine == Opt.CurrentMagazine);
+				TestTrueExpr(DelegateHandler->OnShotFiredCounter > 1);
+			});
+
+			It("Should select the policy again when a setting changes while playing", [this]
+			{
+				FComponentOptions Opt;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.CurrentMagazine = 5;
+				Opt.FireRateRpm = 600;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->ShotsFiredDuringBurstFire = 3;
+				Component->SetIsBurstFire(true);
+
+				const double DeltaTimeRequiredToShoot = Component->GetSecondsBetweenShots() + 0.1;
+				Component->StartFiring();
+				World.Tick(DeltaTimeRequiredToShoot);
+				World.Tick(DeltaTimeRequiredToShoot);
+				TestTrueExpr(Component->CurrentMagazine == 2 && DelegateHandler->OnShotFiredCounter == 3);
+				TestTrueExpr(Component->GetStatus() == EBallisticWeaponStatus::Ready);
+
+				Component->SetHasInfiniteAmmo(true);
+				World.Tick(DeltaTimeRequiredToShoot);
+				Component->StartFiring();
+				World.Tick(DeltaTimeRequiredToShoot);
+				World.Tick(DeltaTimeRequiredToShoot);
+				TestTrueExpr(Component->CurrentMagazine == 2 && DelegateHandler->OnShotFiredCounter == 6);
+			});
+
+			// Benchmark, compare the logged cost across changes to the firing path
+			It("Should log the cost of each tick firing a shot", [this]
+			{
+				constexpr int32 Ticks = 1000;
+				FComponentOptions Opt;
+				Opt.HasInfiniteAmmo = true;
+				Opt.AmmoType.IsHitScan = true;
+				Opt.AmmoType.DamageType = UDamageType::StaticClass();
+				Opt.FireRateRpm = 600;
+				auto* Component = CreateAndAttachComponent(Opt);
+				Component->SetFiringStrategy(EBallisticWeaponFiringStrategy::TimestampIntegerBased);
+				auto* Statistics = SpawnTarget(Opt.FireRateRpm);
+				// A shot is due every tick
+				const float DeltaTime = Component->GetSecondsBetweenShots();
+				Component->StartFiring();
+
+				// The World advances the clock, the weapon is updated by hand so only its own work is timed
+				double Seconds = 0;
+				for (int32 i = 0; i < Ticks; ++i)
+				{
+					Component->SetComponentTickEnabled(false);
+					World.Tick(DeltaTime);
+					const double Start = FPlatformTime::Seconds();
+					Component->TickComponent(DeltaTime, LEVELTICK_All, &Component->PrimaryComponentTick);
+					Seconds += FPlatformTime::Seconds() - Start;
+				}
+				Component->StopFiring();
+
+				UE_LOGFMT(LogWeaponSystemTest, Display, "Weapon firing: {Tick} us per tick, {Hits} hits.",
+				          Seconds / Ticks * 1e6, Statistics->TotalHits);
+				TestTrueExpr(Statistics->TotalHits >= Ticks);
+				Statistics->Destroy();
 			});
 		});
 
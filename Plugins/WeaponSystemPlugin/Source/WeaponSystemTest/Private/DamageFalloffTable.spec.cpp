@@ -0,0 +1,70 @@
+﻿#include "DamageFalloffTable.h"
+
+#include "Engine/CurveTable.h"
+
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FDamageFalloffTable_Spec, "WeaponSystemPlugin.Runtime.DamageFalloffTable",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	TObjectPtr<UCurveTable> CurveTable;
+	FScalableFloat Damage;
+
+END_DEFINE_SPEC(FDamageFalloffTable_Spec)
+
+void FDamageFalloffTable_Spec::Define()
+{
+	Describe("FDamageFalloffTable", [this]
+	{
+		BeforeEach([this]
+		{
+			// 100 HP up to 10 m, then it falls off linearly to 20 HP at 50 m
+			CurveTable = NewObject<UCurveTable>();
+			FRichCurve& Curve = CurveTable->AddRichCurve("Falloff");
+			Curve.AddKey(0, 100);
+			Curve.AddKey(1000, 100);
+			Curve.AddKey(5000, 20);
+			Damage = FScalableFloat(1);
+			Damage.Curve.CurveTable = CurveTable;
+			Damage.Curve.RowName = "Falloff";
+		});
+
+		AfterEach([this]
+		{
+			CurveTable = nullptr;
+		});
+
+		It("Should match the curve at the samples", [this]
+		{
+			FDamageFalloffTable Table;
+			Table.Bake(Damage, 5000, 6);
+			TestTrueExpr(Table.Num() == 6);
+			TestTrueExpr(FMath::IsNearlyEqual(Table.Evaluate(0), 100.f));
+			TestTrueExpr(FMath::IsNearlyEqual(Table.Evaluate(1000), 100.f));
+			TestTrueExpr(FMath::IsNearlyEqual(Table.Evaluate(3000), 60.f));
+			TestTrueExpr(FMath::IsNearlyEqual(Table.Evaluate(5000), 20.f));
+		});
+
+		It("Should clamp distances outside the baked range", [this]
+		{
+			FDamageFalloffTable Table;
+			Table.Bake(Damage, 5000, 6);
+			TestTrueExpr(FMath::IsNearlyEqual(Table.Evaluate(-100), 100.f));
+			TestTrueExpr(FMath::IsNearlyEqual(Table.Evaluate(100000), 20.f));
+		});
+
+		It("Should get closer to the curve with more samples", [this]
+		{
+			FDamageFalloffTable CoarseTable;
+			CoarseTable.Bake(Damage, 5000, 4);
+			FDamageFalloffTable FineTable;
+			FineTable.Bake(Damage, 5000, 101);
+			const float CoarseError = CoarseTable.CalculateMaxError(Damage, 1000);
+			const float FineError = FineTable.CalculateMaxError(Damage, 1000);
+			TestTrueExpr(CoarseError > 1.f);
+			TestTrueExpr(FineError < KINDA_SMALL_NUMBER * 100);
+		});
+	});
+}
@@ -0,0 +1,155 @@
+﻿#include "DamageableComponent.h"
+#include "DamageableSpatialHashSubsystem.h"
+#include "TestWorldSubsystem.h"
+
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FDamageableSpatialHash_Spec, "WeaponSystemPlugin.Runtime.DamageableSpatialHash",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	TObjectPtr<UTestWorldSubsystem> Subsystem;
+	FTestWorldHelper World;
+	UDamageableSpatialHashSubsystem* SpatialHash;
+	TArray<AActor*> Targets;
+
+	AActor* SpawnTarget(const FVector& Location)
+	{
+		auto* Target = World->SpawnActor<AActor>();
+		auto* Root = NewObject<USceneComponent>(Target);
+		Target->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Root->SetWorldLocation(Location);
+		SpatialHash->Register(Target);
+		Targets.Add(Target);
+		return Target;
+	}
+
+END_DEFINE_SPEC(FDamageableSpatialHash_Spec)
+
+void FDamageableSpatialHash_Spec::Define()
+{
+	Describe("UDamageableSpatialHashSubsystem", [this]
+	{
+		BeforeEach([this]
+		{
+			if (!Subsystem)
+			{
+				Subsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			}
+			World = Subsystem->GetSharedWorld();
+			SpatialHash = World->GetSubsystem<UDamageableSpatialHashSubsystem>();
+		});
+
+		AfterEach([this]
+		{
+			for (AActor* Target : Targets)
+			{
+				SpatialHash->Unregister(Target);
+				Target->Destroy();
+			}
+			Targets.Reset();
+		});
+
+		It("Should find only the Actors within the radius", [this]
+		{
+			const AActor* Near = SpawnTarget(FVector(100, 0, 0));
+			const AActor* Across = SpawnTarget(FVector(-1100, 0, 0));
+			SpawnTarget(FVector(5000, 0, 0));
+
+			TArray<AActor*> Found;
+			SpatialHash->FindInRadius(FVector::ZeroVector, 1200, Found);
+			TestTrueExpr(Found.Num() == 2 && Found.Contains(Near) && Found.Contains(Across));
+		});
+
+		It("Should sort the nearest Actors and skip the ignored one", [this]
+		{
+			const AActor* First = SpawnTarget(FVector(0, 100, 0));
+			const AActor* Second = SpawnTarget(FVector(0, 0, 300));
+			const AActor* Third = SpawnTarget(FVector(-600, 0, 0));
+
+			TArray<AActor*> Found;
+			SpatialHash->FindNearest(FVector::ZeroVector, 2, 1000, Found);
+			TestTrueExpr(Found.Num() == 2 && Found[0] == First && Found[1] == Second);
+			TestTrueExpr(SpatialHash->FindNearest(FVector::ZeroVector, 1000, First) == Second);
+			TestTrueExpr(SpatialHash->FindNearest(FVector(-2000, 0, 0), 1000) == nullptr);
+			TestTrueExpr(SpatialHash->FindNearest(FVector(-2000, 0, 0), 1500) == Third);
+		});
+
+		It("Should follow the Actors that moved to another cell", [this]
+		{
+			AActor* Target = SpawnTarget(FVector(100, 0, 0));
+			TestTrueExpr(SpatialHash->FindNearest(FVector(10000, 0, 0), 500) == nullptr);
+
+			Target->SetActorLocation(FVector(10100, 0, 0));
+			World.Tick();
+			TestTrueExpr(SpatialHash->FindNearest(FVector(10000, 0, 0), 500) == Target);
+			TestTrueExpr(SpatialHash->FindNearest(FVector::ZeroVector, 500) == nullptr);
+		});
+
+		It("Should drop the destroyed Actors", [this]
+		{
+			AActor* Destroyed = SpawnTarget(FVector(100, 0, 0));
+			const AActor* Survivor = SpawnTarget(FVector(200, 0, 0));
+			Targets.Remove(Destroyed);
+			Destroyed->Destroy();
+
+			World.Tick();
+			TestTrueExpr(SpatialHash->Num() == 1);
+			TestTrueExpr(SpatialHash->FindNearest(FVector::ZeroVector, 500) == Survivor);
+		});
+
+		It("Should unregister the Actors as soon as they're destroyed", [this]
+		{
+			AActor* Destroyed = SpawnTarget(FVector(100, 0, 0));
+			const AActor* Survivor = SpawnTarget(FVector(200, 0, 0));
+			Targets.Remove(Destroyed);
+			Destroyed->Destroy();
+
+			TArray<AActor*> Found;
+			SpatialHash->FindInRadius(FVector::ZeroVector, 500, Found);
+			TestTrueExpr(SpatialHash->Num() == 1 && Found.Num() == 1 && Found[0] == Survivor);
+		});
+
+		It("Should register the owner of a Damageable Component", [this]
+		{
+			auto* Target = World->SpawnActor<AActor>();
+			auto* Root = NewObject<USceneComponent>(Target);
+			Target->SetRootComponent(Root);
+			Root->RegisterComponent();
+			Root->SetWorldLocation(FVector(100, 0, 0));
+			auto* Damageable = NewObject<UDamageableComponent>(Target);
+			Damageable->RegisterComponent();
+			TestTrueExpr(SpatialHash->Num() == 1 && SpatialHash->FindNearest(FVector::ZeroVector, 500) == Target);
+
+			Damageable->DestroyComponent();
+			TestTrueExpr(SpatialHash->Num() == 0);
+			Target->Destroy();
+		});
+
+		It("Should answer a batch of queries like the single ones", [this]
+		{
+			for (int32 i = 0; i < 50; ++i)
+			{
+				SpawnTarget(FVector(i * 250, (i % 7) * 150, 0));
+			}
+
+			TArray<FVector> Locations;
+			for (int32 i = 0; i < 200; ++i)
+			{
+				Locations.Emplace(i * 60, 400, 0);
+			}
+			TArray<AActor*> Nearest;
+			Nearest.SetNumZeroed(Locations.Num());
+			SpatialHash->FindNearestBatch(Locations, 800, Nearest);
+
+			bool AllMatch = true;
+			for (int32 i = 0; i < Locations.Num(); ++i)
+			{
+				AllMatch &= Nearest[i] == SpatialHash->FindNearest(Locations[i], 800);
+			}
+			TestTrueExpr(AllMatch);
+		});
+	});
+}
@@ -0,0 +1,174 @@
+﻿#include "HitboxBVHSubsystem.h"
+#include "HitboxComponent.h"
+#include "TestWorldSubsystem.h"
+
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FHitboxBVH_Spec, "WeaponSystemPlugin.Runtime.HitboxBVH",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	TObjectPtr<UTestWorldSubsystem> Subsystem;
+	FTestWorldHelper World;
+	UHitboxBVHSubsystem* HitboxBVH;
+	TArray<AActor*> Targets;
+
+	UHitboxComponent* SpawnTarget(const FVector& Location, TConstArrayView<FHitboxShape> Shapes)
+	{
+		auto* Target = World->SpawnActor<AActor>();
+		auto* Root = NewObject<USceneComponent>(Target);
+		Target->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Root->SetWorldLocation(Location);
+
+		auto* Hitbox = NewObject<UHitboxComponent>(Target);
+		Hitbox->Shapes = Shapes;
+		Hitbox->RegisterComponent();
+		Targets.Add(Target);
+		return Hitbox;
+	}
+
+	static FHitboxShape MakeShape(EHitboxShapeType Type, FName BoneName = NAME_None)
+	{
+		FHitboxShape Shape;
+		Shape.Type = Type;
+		Shape.BoneName = BoneName;
+		return Shape;
+	}
+
+END_DEFINE_SPEC(FHitboxBVH_Spec)
+
+void FHitboxBVH_Spec::Define()
+{
+	Describe("UHitboxBVHSubsystem", [this]
+	{
+		BeforeEach([this]
+		{
+			if (!Subsystem)
+			{
+				Subsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			}
+			World = Subsystem->GetSharedWorld();
+			HitboxBVH = World->GetSubsystem<UHitboxBVHSubsystem>();
+		});
+
+		AfterEach([this]
+		{
+			for (AActor* Target : Targets)
+			{
+				Target->Destroy();
+			}
+			Targets.Reset();
+			HitboxBVH->Refresh();
+		});
+
+		It("Should hit each kind of shape where it's crossed", [this]
+		{
+			FHitboxShape Sphere = MakeShape(EHitboxShapeType::Sphere, "head");
+			Sphere.Radius = 50;
+			FHitboxShape Capsule = MakeShape(EHitboxShapeType::Capsule, "spine");
+			Capsule.Radius = 30;
+			Capsule.HalfHeight = 100;
+			FHitboxShape Box = MakeShape(EHitboxShapeType::Box, "pelvis");
+			Box.BoxExtent = FVector(50);
+			Box.Rotation = FRotator(0, 45, 0);
+			SpawnTarget(FVector(500, 0, 0), {Sphere});
+			SpawnTarget(FVector(0, 500, 0), {Capsule});
+			SpawnTarget(FVector(0, 0, 500), {Box});
+			HitboxBVH->Refresh();
+			TestTrueExpr(HitboxBVH->Num() == 3);
+
+			FHitResult Hit;
+			TestTrueExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(1000, 0, 0), Hit));
+			TestTrueExpr(FMath::IsNearlyEqual(Hit.Distance, 450.f, 0.01f) && Hit.BoneName == "head");
+			TestTrueExpr(Hit.ImpactNormal.Equals(-FVector::XAxisVector, 0.001));
+
+			TestTrueExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(0, 1000, 0), Hit));
+			TestTrueExpr(FMath::IsNearlyEqual(Hit.Distance, 470.f, 0.01f) && Hit.BoneName == "spine");
+			TestTrueExpr(HitboxBVH->Raycast(FVector(0, 500, 300), FVector(0, 500, -300), Hit));
+			TestTrueExpr(FMath::IsNearlyEqual(Hit.Distance, 200.f, 0.01f));
+
+			TestTrueExpr(HitboxBVH->Raycast(FVector(-500, 0, 500), FVector(500, 0, 500), Hit));
+			TestTrueExpr(FMath::IsNearlyEqual(Hit.Distance, 500 - 50 * UE_SQRT_2, 0.01f) && Hit.BoneName == "pelvis");
+			TestTrueExpr(Hit.GetActor() == Targets[2]);
+
+			TestFalseExpr(HitboxBVH->Raycast(FVector(0, 0, -100), FVector(0, 0, -1000), Hit));
+		});
+
+		It("Should skip the ignored Actor and the unregistered hitboxes", [this]
+		{
+			const FHitboxShape Sphere = MakeShape(EHitboxShapeType::Sphere);
+			SpawnTarget(FVector(100, 0, 0), {Sphere});
+			UHitboxComponent* Farther = SpawnTarget(FVector(300, 0, 0), {Sphere});
+			HitboxBVH->Refresh();
+
+			FHitResult Hit;
+			TestTrueExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(1000, 0, 0), Hit, Targets[0]));
+			TestTrueExpr(Hit.GetActor() == Targets[1]);
+
+			// Until the next Refresh too
+			Farther->DestroyComponent();
+			TestFalseExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(1000, 0, 0), Hit, Targets[0]));
+		});
+
+		It("Should hit the hitboxes of an offset owner where they've been moved, without a Refresh", [this]
+		{
+			FHitboxShape Sphere = MakeShape(EHitboxShapeType::Sphere);
+			Sphere.Radius = 50;
+			SpawnTarget(FVector(500, 0, 0), {Sphere});
+			SpawnTarget(FVector(0, 500, 0), {Sphere});
+			HitboxBVH->Refresh();
+
+			// The first target is turned around the origin, from X to -X
+			HitboxBVH->SetOwnerOffset(Targets[0], FTransform(FRotator(0, 180, 0), FVector::ZeroVector));
+			FHitResult Hit;
+			TestFalseExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(1000, 0, 0), Hit));
+			TestTrueExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(-1000, 0, 0), Hit));
+			TestTrueExpr(Hit.GetActor() == Targets[0] && FMath::IsNearlyEqual(Hit.Distance, 450.f, 0.01f));
+			TestTrueExpr(Hit.ImpactPoint.Equals(FVector(-450, 0, 0), 0.01));
+			TestTrueExpr(Hit.ImpactNormal.Equals(FVector::XAxisVector, 0.001));
+			TestTrueExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(0, 1000, 0), Hit));
+			TestTrueExpr(Hit.GetActor() == Targets[1]);
+
+			HitboxBVH->ResetOwnerOffsets();
+			TestTrueExpr(HitboxBVH->Raycast(FVector::ZeroVector, FVector(1000, 0, 0), Hit));
+			TestTrueExpr(Hit.GetActor() == Targets[0]);
+		});
+
+		It("Should find the same hits as testing every hitbox", [this]
+		{
+			FRandomStream Stream(42);
+			TArray<FVector> Centers;
+			for (int32 i = 0; i < 300; ++i)
+			{
+				Centers.Add(Stream.VRand() * Stream.FRandRange(200, 2000));
+				SpawnTarget(Centers.Last(), {MakeShape(EHitboxShapeType::Sphere)});
+			}
+			HitboxBVH->Refresh();
+
+			int32 Mismatches = 0;
+			for (int32 Ray = 0; Ray < 200; ++Ray)
+			{
+				const FVector End = Stream.VRand() * 3000;
+				double Nearest = TNumericLimits<double>::Max();
+				for (const FVector& Center : Centers)
+				{
+					const FVector Intersection = FMath::ClosestPointOnSegment(Center, FVector::ZeroVector, End);
+					if (FVector::Distance(Intersection, Center) <= 10)
+					{
+						const double Along = Intersection.Size();
+						const double HalfChord = FMath::Sqrt(100 - FVector::DistSquared(Intersection, Center));
+						Nearest = FMath::Min(Nearest, Along - HalfChord);
+					}
+				}
+
+				FHitResult Hit;
+				const bool HasHit = HitboxBVH->Raycast(FVector::ZeroVector, End, Hit);
+				const bool ShouldHit = Nearest != TNumericLimits<double>::Max();
+				Mismatches += HasHit != ShouldHit || (HasHit && !FMath::IsNearlyEqual(Hit.Distance, Nearest, 0.1));
+			}
+			TestTrueExpr(Mismatches == 0);
+		});
+	});
+}
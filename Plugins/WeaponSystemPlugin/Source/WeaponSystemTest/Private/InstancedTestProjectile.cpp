@@ -0,0 +1,14 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+
+#include "InstancedTestProjectile.h"
+
+#include "GameFramework/DamageType.h"
+
+AInstancedTestProjectile::AInstancedTestProjectile()
+{
+	ProjectileMovementComponent->InitialSpeed = 1000;
+	ProjectileMovementComponent->ProjectileGravityScale = 0;
+	DamageType = UDamageType::StaticClass();
+	UseInstancedVisuals = true;
+}
@@ -0,0 +1,16 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProjectileBase.h"
+#include "InstancedTestProjectile.generated.h"
+
+UCLASS()
+class AInstancedTestProjectile : public AProjectileBase
+{
+	GENERATED_BODY()
+
+public:
+	AInstancedTestProjectile();
+};
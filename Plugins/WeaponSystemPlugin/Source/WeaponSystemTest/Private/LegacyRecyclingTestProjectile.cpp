@@ -0,0 +1,48 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+
+#include "LegacyRecyclingTestProjectile.h"
+
+void ALegacyRecyclingTestProjectile::HandleLegacyOverlap(AActor* OverlappedActor, AActor* OtherActor)
+{
+}
+
+void ALegacyRecyclingTestProjectile::LegacyAcquiredFromPool(const FTransform& NewTransform, AActor* NewOwner)
+{
+	if (EnableSpawnOffsetToAvoidWeaponCollision)
+	{
+		const double Offset = ProjectileMeshComponent->Bounds.SphereRadius + 1.f;
+		FTransform TransformWithOffset = NewTransform;
+		TransformWithOffset.SetLocation(NewTransform.GetLocation() + NewTransform.GetRotation().GetForwardVector() * Offset);
+		SetActorTransform(TransformWithOffset, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	else
+	{
+		SetActorTransform(NewTransform, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	SetOwner(NewOwner);
+	SpawnLocation = GetActorLocation();
+	OnActorBeginOverlap.AddDynamic(this, &ALegacyRecyclingTestProjectile::HandleLegacyOverlap);
+	SetActorEnableCollision(true);
+	SetActorHiddenInGame(false);
+	if (ProjectileMovementComponent->HasStoppedSimulation())
+	{
+		const FVector Velocity = GetActorForwardVector() * ProjectileMovementComponent->InitialSpeed;
+		ProjectileMovementComponent->Velocity = ProjectileMovementComponent->ComputeVelocity(Velocity, 0);
+		ProjectileMovementComponent->SetUpdatedComponent(RootComponent);
+		ProjectileMovementComponent->SetActive(true);
+	}
+	TraveledDistance = 0;
+	PreviousSweepLocation = SpawnLocation;
+	PreviousSweepVelocity = ProjectileMovementComponent->Velocity;
+	SweptActorsHit.Reset();
+}
+
+void ALegacyRecyclingTestProjectile::LegacyReleasedToPool()
+{
+	ProjectileMovementComponent->StopSimulating({});
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+	OnActorBeginOverlap.RemoveDynamic(this, &ALegacyRecyclingTestProjectile::HandleLegacyOverlap);
+}
@@ -0,0 +1,25 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TestProjectile.h"
+#include "LegacyRecyclingTestProjectile.generated.h"
+
+/**
+ * Recycles itself like AProjectileBase did before binding its overlap once:
+ * the delegate is bound and unbound by name and the movement is rebuilt on every cycle.
+ * Only used as the baseline of the recycling benchmark.
+ */
+UCLASS()
+class ALegacyRecyclingTestProjectile : public ATestProjectile
+{
+	GENERATED_BODY()
+
+	UFUNCTION()
+	void HandleLegacyOverlap(AActor* OverlappedActor, AActor* OtherActor);
+
+public:
+	void LegacyAcquiredFromPool(const FTransform& NewTransform, AActor* NewOwner);
+	void LegacyReleasedToPool();
+};
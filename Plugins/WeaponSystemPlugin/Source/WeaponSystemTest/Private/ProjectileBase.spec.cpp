@@ -0,0 +1,181 @@
+﻿#include "DamageableSpatialHashSubsystem.h"
+#include "ScopedAllocationCounter.h"
+#include "TestProjectile.h"
+#include "TestWorldSubsystem.h"
+#include "TypedActorPool.h"
+#include "WeaponRpmStatistics.h"
+
+#include "EngineUtils.h"
+
+#include "GameFramework/DamageType.h"
+
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FProjectileBase_Spec, "WeaponSystemPlugin.Runtime.ProjectileBase",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	TObjectPtr<UTestWorldSubsystem> Subsystem;
+	FTestWorldHelper World;
+
+	// A target registered to the spatial hash, that doesn't collide with the projectiles.
+	AWeaponRpmStatistics* SpawnTarget(const FVector& Location)
+	{
+		auto* Target = World->SpawnActor<AWeaponRpmStatistics>();
+		auto* Root = NewObject<USceneComponent>(Target);
+		Target->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Root->SetWorldLocation(Location);
+		Target->ExpectedDamageTypeClass = UDamageType::StaticClass();
+		Target->DumpCsvOnCompletion = false;
+		World->GetSubsystem<UDamageableSpatialHashSubsystem>()->Register(Target);
+		return Target;
+	}
+
+END_DEFINE_SPEC(FProjectileBase_Spec)
+
+void FProjectileBase_Spec::Define()
+{
+	Describe("AProjectileBase", [this]
+	{
+		BeforeEach([this]
+		{
+			if (!Subsystem)
+			{
+				Subsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			}
+			World = Subsystem->GetSharedWorld();
+		});
+
+		Describe("When recycled through the pool", [this]
+		{
+			It("Should stop flying and colliding while in the pool", [this]
+			{
+				TActorPool<ATestProjectile> Pool(World->GetWorld());
+				ATestProjectile* Projectile = Pool.Acquire();
+				TestTrueExpr(Projectile->GetActorEnableCollision() && Projectile->IsActorTickEnabled());
+
+				Pool.Release(Projectile);
+				TestTrueExpr(!Projectile->GetActorEnableCollision() && !Projectile->IsActorTickEnabled());
+				TestTrueExpr(Projectile->IsHidden() && Projectile->ProjectileMovementComponent->Velocity.IsZero());
+
+				const FTransform Transform(FRotator(0, 90, 0), FVector(0, 0, 500));
+				TestTrueExpr(Pool.Acquire(Transform) == Projectile);
+				const FVector Velocity = Projectile->ProjectileMovementComponent->Velocity;
+				TestTrueExpr(Velocity.GetSafeNormal().Equals(FVector::RightVector) && Projectile->GetActorEnableCollision());
+				Pool.Release(Projectile);
+			});
+
+			It("Should wait in the pool and fly once acquired, when prewarmed", [this]
+			{
+				TActorPool<ATestProjectile> Pool(World->GetWorld());
+				Pool.Populate(2);
+
+				bool AllPooled = true;
+				for (TActorIterator<ATestProjectile> It(World->GetWorld()); It; ++It)
+				{
+					AllPooled &= It->IsHidden() && !It->GetActorEnableCollision() && !It->IsActorTickEnabled();
+					AllPooled &= It->ProjectileMovementComponent->Velocity.IsZero();
+				}
+				TestTrueExpr(AllPooled);
+
+				const FTransform Transform(FRotator(0, 90, 0), FVector(0, 0, 500));
+				ATestProjectile* Projectile = Pool.Acquire(Transform);
+				const FVector Velocity = Projectile->ProjectileMovementComponent->Velocity;
+				TestTrueExpr(Velocity.GetSafeNormal().Equals(FVector::RightVector));
+				TestTrueExpr(!Projectile->IsHidden() && Projectile->GetActorEnableCollision() && Projectile->IsActorTickEnabled());
+				Pool.Release(Projectile);
+			});
+
+			It("Shouldnt allocate memory, once warmed up", [this]
+			{
+				TActorPool<ATestProjectile> Pool(World->GetWorld());
+				Pool.Release(Pool.Acquire());
+
+				int64 Allocations = 0;
+				for (int32 i = 0; i < 100; ++i)
+				{
+					FScopedAllocationCounter Counter;
+					Pool.Release(Pool.Acquire());
+					Allocations += Counter.GetAllocations();
+				}
+				TestTrueExpr(Allocations == 0);
+			});
+		});
+
+		Describe("When looking for targets", [this]
+		{
+			It("Should steer towards the nearest target, when homing", [this]
+			{
+				auto* Target = SpawnTarget(FVector(500, 500, 0));
+				auto* Projectile = World->SpawnActorDeferred<ATestProjectile>(
+					ATestProjectile::StaticClass(), FTransform::Identity);
+				Projectile->UseHoming = true;
+				Projectile->ProjectileMovementComponent->HomingAccelerationMagnitude = 10000;
+				Projectile->FinishSpawning(FTransform::Identity);
+
+				for (int32 i = 0; i < 5; ++i)
+				{
+					World.Tick(0.05);
+				}
+				TestTrueExpr(Projectile->ProjectileMovementComponent->HomingTargetComponent == Target->GetRootComponent());
+				TestTrueExpr(Projectile->ProjectileMovementComponent->Velocity.Y > 0);
+				Projectile->Destroy();
+				Target->Destroy();
+			});
+
+			It("Should detonate near a target, with the proximity fuse", [this]
+			{
+				auto* Target = SpawnTarget(FVector(300, 0, 0));
+				auto* Projectile = World->SpawnActorDeferred<ATestProjectile>(
+					ATestProjectile::StaticClass(), FTransform::Identity);
+				Projectile->ProximityFuseRadius = 100;
+				Projectile->FinishSpawning(FTransform::Identity);
+
+				// 1000 cm/s, the target is in range after 0.2 seconds
+				World.Tick(0.1);
+				TestTrueExpr(Target->TotalHits == 0 && Projectile->IsActorTickEnabled());
+				for (int32 i = 0; i < 3; ++i)
+				{
+					World.Tick(0.1);
+				}
+				TestTrueExpr(Target->TotalHits == 1 && Projectile->IsHidden() && !Projectile->IsActorTickEnabled());
+
+				// The fused projectile went back to the pool, it isn't reused by the other tests
+				TestTrueExpr(TActorPool<ATestProjectile>(World->GetWorld()).Acquire() == Projectile);
+				Projectile->Destroy();
+				Target->Destroy();
+			});
+
+			It("Should damage every target in range, when exploding", [this]
+			{
+				auto* Target = SpawnTarget(FVector(300, 0, 0));
+				auto* Bystander = SpawnTarget(FVector(300, 300, 0));
+				auto* Projectile = World->SpawnActorDeferred<ATestProjectile>(
+					ATestProjectile::StaticClass(), FTransform::Identity);
+				Projectile->ProximityFuseRadius = 100;
+				Projectile->Damage.Value = 100;
+				Projectile->UseRadialDamage = true;
+				// Designer data out of order, clamped instead of asserting
+				Projectile->ExplosionInnerRadius = 1000;
+				Projectile->ExplosionOuterRadius = 500;
+				Projectile->ExplosionTraceOcclusion = false;
+				Projectile->FinishSpawning(FTransform::Identity);
+
+				for (int32 i = 0; i < 4; ++i)
+				{
+					World.Tick(0.1);
+				}
+				TestTrueExpr(Target->TotalHits == 1 && Bystander->TotalHits == 1);
+				TestTrueExpr(Bystander->LastExplosionOrigin.IsSet()
+					&& FVector::Distance(*Bystander->LastExplosionOrigin, Target->GetActorLocation()) <= 100);
+
+				TestTrueExpr(TActorPool<ATestProjectile>(World->GetWorld()).Acquire() == Projectile);
+				Projectile->Destroy();
+				Target->Destroy();
+				Bystander->Destroy();
+			});
+		});
+	});
+}
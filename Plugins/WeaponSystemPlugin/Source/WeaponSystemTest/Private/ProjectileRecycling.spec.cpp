@@ -0,0 +1,84 @@
+﻿#include "LegacyRecyclingTestProjectile.h"
+#include "LogWeaponSystemTest.h"
+#include "TestProjectile.h"
+#include "TestWorldSubsystem.h"
+
+#include "HAL/PlatformTime.h"
+#include "Logging/StructuredLog.h"
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FProjectileRecycling_Spec, "WeaponSystemPlugin.Perf.ProjectileRecycling",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::PerfFilter)
+
+	TObjectPtr<UTestWorldSubsystem> Subsystem;
+	FTestWorldHelper World;
+
+	static constexpr int32 Cycles = 10000;
+
+	// Average microseconds spent by a release followed by an acquire.
+	template <typename FRecycleFn>
+	static double MeasureRecycling(FRecycleFn&& Recycle)
+	{
+		for (int32 i = 0; i < 100; ++i)
+		{
+			Recycle(i);
+		}
+
+		const double Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Cycles; ++i)
+		{
+			Recycle(i);
+		}
+		return (FPlatformTime::Seconds() - Start) * 1e6 / Cycles;
+	}
+
+	static FTransform MakeTransform(int32 Cycle)
+	{
+		return FTransform(FRotator(0, Cycle % 360, 0), FVector(0, 0, 500 + Cycle % 100));
+	}
+
+END_DEFINE_SPEC(FProjectileRecycling_Spec)
+
+void FProjectileRecycling_Spec::Define()
+{
+	Describe("Recycling a projectile", [this]
+	{
+		BeforeEach([this]
+		{
+			if (!Subsystem)
+			{
+				Subsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			}
+			World = Subsystem->GetSharedWorld();
+		});
+
+		It("Should be faster binding once than rebinding on every cycle", [this]
+		{
+			auto* Legacy = World->SpawnActor<ALegacyRecyclingTestProjectile>();
+			auto* Current = World->SpawnActor<ATestProjectile>();
+
+			const double LegacyMicroseconds = MeasureRecycling([Legacy](int32 Cycle)
+			{
+				Legacy->LegacyReleasedToPool();
+				Legacy->LegacyAcquiredFromPool(MakeTransform(Cycle), nullptr);
+			});
+			const double CurrentMicroseconds = MeasureRecycling([Current](int32 Cycle)
+			{
+				Current->ReleasedToPool();
+				Current->AcquiredFromPool(MakeTransform(Cycle), nullptr);
+			});
+
+			UE_LOGFMT(LogWeaponSystemTest, Display,
+			          "Recycling over {Cycles} cycles: rebinding {Legacy} us, binding once {Current} us, {Speedup}x.",
+			          Cycles, LegacyMicroseconds, CurrentMicroseconds, LegacyMicroseconds / CurrentMicroseconds);
+
+			TestTrueExpr(Legacy->GetActorEnableCollision() && Current->GetActorEnableCollision());
+			TestTrueExpr(CurrentMicroseconds <= LegacyMicroseconds);
+
+			Legacy->Destroy();
+			Current->Destroy();
+		});
+	});
+}
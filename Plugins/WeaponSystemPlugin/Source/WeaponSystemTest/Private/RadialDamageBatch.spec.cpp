@@ -0,0 +1,134 @@
+﻿#include "DamageableSpatialHashSubsystem.h"
+#include "RadialDamageBatchSubsystem.h"
+#include "TestWorldSubsystem.h"
+#include "WeaponRpmStatistics.h"
+
+#include "Components/BoxComponent.h"
+
+#include "Engine/CollisionProfile.h"
+
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FRadialDamageBatch_Spec, "WeaponSystemPlugin.Runtime.RadialDamageBatch",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	TObjectPtr<UTestWorldSubsystem> Subsystem;
+	FTestWorldHelper World;
+	URadialDamageBatchSubsystem* RadialDamage;
+	UDamageableSpatialHashSubsystem* SpatialHash;
+	TArray<AActor*> SpawnedActors;
+
+	AActor* SpawnBox(AActor* Actor, const FVector& Location)
+	{
+		auto* Box = NewObject<UBoxComponent>(Actor);
+		Box->SetBoxExtent(FVector(20));
+		Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Actor->SetRootComponent(Box);
+		Box->RegisterComponent();
+		Box->SetWorldLocation(Location);
+		SpawnedActors.Add(Actor);
+		return Actor;
+	}
+
+	AWeaponRpmStatistics* SpawnTarget(const FVector& Location)
+	{
+		auto* Target = World->SpawnActor<AWeaponRpmStatistics>();
+		SpawnBox(Target, Location);
+		Target->ExpectedDamageTypeClass = UDamageType::StaticClass();
+		Target->SecondsToSample = 60 * 60;
+		Target->DumpCsvOnCompletion = false;
+		SpatialHash->Register(Target);
+		return Target;
+	}
+
+	FRadialDamageExplosion MakeExplosion(const FVector& Origin) const
+	{
+		FRadialDamageExplosion Explosion;
+		Explosion.Origin = Origin;
+		Explosion.BaseDamage = 100;
+		Explosion.MinimumDamage = 10;
+		Explosion.InnerRadius = 100;
+		Explosion.OuterRadius = 500;
+		Explosion.DamageType = UDamageType::StaticClass();
+		return Explosion;
+	}
+
+END_DEFINE_SPEC(FRadialDamageBatch_Spec)
+
+void FRadialDamageBatch_Spec::Define()
+{
+	Describe("URadialDamageBatchSubsystem", [this]
+	{
+		BeforeEach([this]
+		{
+			if (!Subsystem)
+			{
+				Subsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			}
+			World = Subsystem->GetSharedWorld();
+			RadialDamage = World->GetSubsystem<URadialDamageBatchSubsystem>();
+			SpatialHash = World->GetSubsystem<UDamageableSpatialHashSubsystem>();
+		});
+
+		AfterEach([this]
+		{
+			for (AActor* Actor : SpawnedActors)
+			{
+				SpatialHash->Unregister(Actor);
+				Actor->Destroy();
+			}
+			SpawnedActors.Reset();
+		});
+
+		It("Should fall off from the inner to the outer radius", [this]
+		{
+			const FRadialDamageExplosion Explosion = MakeExplosion(FVector::ZeroVector);
+			TestTrueExpr(Explosion.GetDamageAtDistance(50) == 100);
+			TestTrueExpr(FMath::IsNearlyEqual(Explosion.GetDamageAtDistance(300), 55.f));
+			TestTrueExpr(Explosion.GetDamageAtDistance(600) == 0);
+		});
+
+		It("Should damage only the targets in range, once per frame", [this]
+		{
+			const auto* Near = SpawnTarget(FVector(0, 200, 0));
+			const auto* Shared = SpawnTarget(FVector(300, 0, 0));
+			const auto* Far = SpawnTarget(FVector(2000, 0, 0));
+
+			RadialDamage->QueueExplosion(MakeExplosion(FVector::ZeroVector));
+			RadialDamage->QueueExplosion(MakeExplosion(FVector(650, 0, 0)));
+			TestTrueExpr(RadialDamage->Num() == 2 && Shared->TotalHits == 0);
+
+			World.Tick();
+			TestTrueExpr(RadialDamage->Num() == 0);
+			TestTrueExpr(Near->TotalHits == 1 && Far->TotalHits == 0);
+			// Reached by both explosions with a single TakeDamage call, carrying the origin of the strongest one
+			TestTrueExpr(Shared->TotalHits == 2);
+			TestTrueExpr(Shared->LastExplosionOrigin.Get(FVector::OneVector) == FVector::ZeroVector);
+		});
+
+		It("Should deal the base damage up to the outer radius, if it isnt past the inner one", [this]
+		{
+			FRadialDamageExplosion Explosion = MakeExplosion(FVector::ZeroVector);
+			Explosion.InnerRadius = 600;
+			TestTrueExpr(Explosion.GetDamageAtDistance(300) == 100 && Explosion.GetDamageAtDistance(550) == 0);
+
+			const auto* Target = SpawnTarget(FVector(300, 0, 0));
+			RadialDamage->QueueExplosion(Explosion);
+			RadialDamage->Flush();
+			TestTrueExpr(Target->TotalHits == 1);
+		});
+
+		It("Shouldnt damage the targets hidden from the explosion", [this]
+		{
+			const auto* Hidden = SpawnTarget(FVector(300, 0, 0));
+			const auto* Visible = SpawnTarget(FVector(-300, 0, 0));
+			SpawnBox(World->SpawnActor<AActor>(), FVector(150, 0, 0));
+
+			RadialDamage->QueueExplosion(MakeExplosion(FVector::ZeroVector));
+			RadialDamage->Flush();
+			TestTrueExpr(Hidden->TotalHits == 0 && Visible->TotalHits == 1);
+		});
+	});
+}
@@ -0,0 +1,184 @@
+﻿#include "HitboxBVHSubsystem.h"
+#include "HitboxComponent.h"
+#include "RewindHistorySubsystem.h"
+#include "ScopedAllocationCounter.h"
+#include "TestWorldSubsystem.h"
+
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Misc/AutomationTest.h"
+
+BEGIN_DEFINE_SPEC(FRewindHistory_Spec, "WeaponSystemPlugin.Runtime.RewindHistory",
+                  EAutomationTestFlags::ApplicationContextMask
+                  | EAutomationTestFlags::MediumPriority
+                  | EAutomationTestFlags::ProductFilter)
+
+	TObjectPtr<UTestWorldSubsystem> Subsystem;
+	FTestWorldHelper World;
+	URewindHistorySubsystem* History;
+	TArray<AActor*> Targets;
+
+	AActor* SpawnTarget()
+	{
+		auto* Target = World->SpawnActor<AActor>();
+		auto* Root = NewObject<UBoxComponent>(Target);
+		Root->SetBoxExtent(FVector(10));
+		Root->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Target->SetRootComponent(Root);
+		Root->RegisterComponent();
+		History->Register(Target);
+		Targets.Add(Target);
+		return Target;
+	}
+
+	// Actor whose body crosses the vertical line through Location
+	AActor* TraceAt(const FVector& Location) const
+	{
+		FHitResult Hit;
+		World->LineTraceSingleByChannel(Hit, Location + FVector(0, 0, 50), Location - FVector(0, 0, 50), ECC_Visibility);
+		return Hit.GetActor();
+	}
+
+END_DEFINE_SPEC(FRewindHistory_Spec)
+
+void FRewindHistory_Spec::Define()
+{
+	Describe("URewindHistorySubsystem", [this]
+	{
+		BeforeEach([this]
+		{
+			if (!Subsystem)
+			{
+				Subsystem = GEngine->GetEngineSubsystem<UTestWorldSubsystem>();
+			}
+			World = Subsystem->GetSharedWorld();
+			History = World->GetSubsystem<URewindHistorySubsystem>();
+		});
+
+		AfterEach([this]
+		{
+			for (AActor* Target : Targets)
+			{
+				History->Unregister(Target);
+				Target->Destroy();
+			}
+			Targets.Reset();
+		});
+
+		It("Should interpolate between the recorded transforms", [this]
+		{
+			AActor* Target = SpawnTarget();
+			Target->SetActorLocation(FVector(0, 0, 0));
+			History->Record(1);
+			Target->SetActorLocationAndRotation(FVector(100, 0, 0), FRotator(0, 90, 0));
+			History->Record(2);
+
+			FTransform Transform;
+			TestTrueExpr(History->GetTransformAt(Target, 1.25, Transform));
+			TestTrueExpr(Transform.GetLocation().Equals(FVector(25, 0, 0)));
+			TestTrueExpr(Transform.Rotator().Equals(FRotator(0, 22.5, 0), 0.01));
+
+			// Clamped to the recorded ones
+			TestTrueExpr(History->GetTransformAt(Target, 0, Transform) && Transform.GetLocation().IsZero());
+			TestTrueExpr(History->GetTransformAt(Target, 5, Transform));
+			TestTrueExpr(Transform.GetLocation().Equals(FVector(100, 0, 0)));
+		});
+
+		It("Should keep only the most recent transforms", [this]
+		{
+			AActor* Target = SpawnTarget();
+			const int32 Samples = 1000;
+			for (int32 i = 0; i < Samples; ++i)
+			{
+				Target->SetActorLocation(FVector(i, 0, 0));
+				History->Record(i);
+			}
+
+			FTransform Transform;
+			TestTrueExpr(History->GetTransformAt(Target, Samples - 10.5, Transform));
+			TestTrueExpr(Transform.GetLocation().Equals(FVector(Samples - 10.5, 0, 0)));
+			// The oldest samples have been overwritten
+			TestTrueExpr(History->GetTransformAt(Target, 0, Transform) && Transform.GetLocation().X > 0);
+		});
+
+		It("Shouldnt allocate memory while recording", [this]
+		{
+			for (int32 i = 0; i < 10; ++i)
+			{
+				SpawnTarget();
+			}
+
+			FScopedAllocationCounter Counter;
+			for (int32 i = 0; i < 500; ++i)
+			{
+				History->Record(i);
+			}
+			TestTrueExpr(Counter.GetAllocations() == 0);
+			TestTrueExpr(History->GetBytesPerTrackedActor() > 0);
+		});
+
+		It("Should put the rewound bodies back where they were", [this]
+		{
+			AActor* Target = SpawnTarget();
+			AActor* Shooter = SpawnTarget();
+			History->Record(1);
+			Target->SetActorLocation(FVector(0, 500, 0));
+			Shooter->SetActorLocation(FVector(0, -500, 0));
+			History->Record(2);
+
+			{
+				FRewindHistoryScope Rewind(History, 1, Shooter);
+				TestTrueExpr(TraceAt(FVector::ZeroVector) == Target);
+				TestTrueExpr(TraceAt(FVector(0, -500, 0)) == Shooter);
+				// Only the physics scene is rewound, so no overlap or movement is triggered
+				TestTrueExpr(Target->GetActorLocation().Equals(FVector(0, 500, 0)));
+			}
+			TestTrueExpr(TraceAt(FVector::ZeroVector) == nullptr);
+			TestTrueExpr(TraceAt(FVector(0, 500, 0)) == Target);
+		});
+
+		It("Should rewind only the Actors that were within the region", [this]
+		{
+			AActor* Near = SpawnTarget();
+			AActor* Far = SpawnTarget();
+			Far->SetActorLocation(FVector(0, 5000, 0));
+			History->Record(1);
+			Near->SetActorLocation(FVector(0, 500, 0));
+			Far->SetActorLocation(FVector(0, 5500, 0));
+			History->Record(2);
+
+			{
+				FRewindHistoryScope Rewind(History, 1, nullptr, FSphere(FVector::ZeroVector, 100));
+				TestTrueExpr(TraceAt(FVector::ZeroVector) == Near);
+				TestTrueExpr(TraceAt(FVector(0, 5000, 0)) == nullptr);
+				TestTrueExpr(TraceAt(FVector(0, 5500, 0)) == Far);
+			}
+		});
+
+		It("Should rewind the hitboxes along their Actor", [this]
+		{
+			AActor* Target = SpawnTarget();
+			Target->SetActorEnableCollision(false);
+			auto* Hitbox = NewObject<UHitboxComponent>(Target);
+			Hitbox->Shapes.AddDefaulted_GetRef().Radius = 20;
+			Hitbox->RegisterComponent();
+			auto* HitboxBVH = World->GetSubsystem<UHitboxBVHSubsystem>();
+			History->Record(1);
+			Target->SetActorLocation(FVector(0, 500, 0));
+			History->Record(2);
+			HitboxBVH->Refresh();
+
+			FHitResult Hit;
+			{
+				FRewindHistoryScope Rewind(History, 1);
+				TestTrueExpr(HitboxBVH->Raycast(FVector(0, 0, 100), FVector(0, 0, -100), Hit));
+				TestTrueExpr(Hit.GetActor() == Target);
+			}
+			TestFalseExpr(HitboxBVH->Raycast(FVector(0, 0, 100), FVector(0, 0, -100), Hit));
+			TestTrueExpr(HitboxBVH->Raycast(FVector(0, 500, 100), FVector(0, 500, -100), Hit));
+
+			Hitbox->DestroyComponent();
+			HitboxBVH->Refresh();
+		});
+	});
+}
@@ -0,0 +1,15 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+
+#include "SimulatedTestProjectile.h"
+
+#include "GameFramework/DamageType.h"
+
+ASimulatedTestProjectile::ASimulatedTestProjectile()
+{
+	ProjectileMovementComponent->InitialSpeed = 10000;
+	ProjectileMovementComponent->ProjectileGravityScale = 0;
+	DamageType = UDamageType::StaticClass();
+	SimulateWithoutActor = true;
+	SimulatedLifetime = 1;
+}
@@ -0,0 +1,16 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProjectileBase.h"
+#include "SimulatedTestProjectile.generated.h"
+
+UCLASS()
+class ASimulatedTestProjectile : public AProjectileBase
+{
+	GENERATED_BODY()
+
+public:
+	ASimulatedTestProjectile();
+};
@@ -0,0 +1,15 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+
+#include "SweptTestProjectile.h"
+
+#include "GameFramework/DamageType.h"
+
+ASweptTestProjectile::ASweptTestProjectile()
+{
+	// Flies way past a target in a single tick
+	ProjectileMovementComponent->InitialSpeed = 100000;
+	ProjectileMovementComponent->ProjectileGravityScale = 0;
+	DamageType = UDamageType::StaticClass();
+	UseSweptCollision = true;
+}
@@ -0,0 +1,16 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProjectileBase.h"
+#include "SweptTestProjectile.generated.h"
+
+UCLASS()
+class ASweptTestProjectile : public AProjectileBase
+{
+	GENERATED_BODY()
+
+public:
+	ASweptTestProjectile();
+};
@@ -0,0 +1,13 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+
+#include "TestProjectile.h"
+
+#include "GameFramework/DamageType.h"
+
+ATestProjectile::ATestProjectile()
+{
+	ProjectileMovementComponent->InitialSpeed = 1000;
+	ProjectileMovementComponent->ProjectileGravityScale = 0;
+	DamageType = UDamageType::StaticClass();
+}
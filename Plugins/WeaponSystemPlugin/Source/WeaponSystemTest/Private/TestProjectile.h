@@ -0,0 +1,16 @@
+﻿// Stefano Famà (famastefano@gmail.com)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProjectileBase.h"
+#include "TestProjectile.generated.h"
+
+UCLASS()
+class ATestProjectile : public AProjectileBase
+{
+	GENERATED_BODY()
+
+public:
+	ATestProjectile();
+};
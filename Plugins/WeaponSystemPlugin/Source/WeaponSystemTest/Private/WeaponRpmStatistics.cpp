@@ -2,6 +2,7 @@
 
 #include "WeaponRpmStatistics.h"
 
+#include "DamageAggregationSubsystem.h"
 #include "LogWeaponSystemTest.h"
 
 #include "Engine/DamageEvents.h"
@@ -13,10 +14,10 @@ void AWeaponRpmStatistics::DumpToCsv(const FString& Path) const
 	UE_LOGFMT(LogWeaponSystemTest, Display, "CSV path `{Path}`", Path);
 
 	FString Data;
-	Data.Append(TEXT("Time (Seconds);Hits;RPM;% Error\n"));
-	for (const auto& [Timestamp, Hits, FireRate, Error] : Snapshots)
+	Data.Append(TEXT("Time (Seconds);Hits;RPM;% Error;Drift (Rounds)\n"));
+	for (const auto& [Timestamp, Hits, FireRate, Error, Drift] : Snapshots)
 	{
-		Data.Appendf(TEXT("%.1f;%d;%.1f;%.1f%%\n"), Timestamp, Hits, FireRate, Error);
+		Data.Appendf(TEXT("%.1f;%d;%.1f;%.1f%%;%.3f\n"), Timestamp, Hits, FireRate, Error, Drift);
 	}
 
 	if (FFileHelper::SaveStringToFile(Data, GetData(Path), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
@@ -76,7 +77,11 @@ float AWeaponRpmStatistics::TakeDamage(float, const FDamageEvent& DamageEvent,
 				UE_LOGFMT(LogWeaponSystemTest, Display, "{CsvName} started sampling at {Timestamp}.", CsvName, Now);
 			}
 
-			++TotalHits;
+			TotalHits += FAggregatedDamageEvent::GetHitCount(DamageEvent);
+			if (DamageEvent.IsOfType(FAggregatedRadialDamageEvent::ClassID))
+			{
+				LastExplosionOrigin = static_cast<const FAggregatedRadialDamageEvent&>(DamageEvent).Origin;
+			}
 		}
 		else
 		{
@@ -103,33 +108,30 @@ void AWeaponRpmStatistics::Tick(float)
 	if (TakeSnapshots && Now >= NextSnapshotTimestamp)
 	{
 		NextSnapshotTimestamp += SecondsBetweenSnapshots;
-		const double Timestamp = Now - InitialTimestamp;
-		Snapshots.Add({
-			Timestamp, TotalHits, CalculateFireRate(Timestamp, TotalHits), CalculateError(Timestamp, TotalHits)
-		});
+		Snapshots.Add(MakeSnapshot(Now - InitialTimestamp));
 	}
 
 	if (Now >= TerminationTimestamp)
 	{
 		UE_LOGFMT(LogWeaponSystemTest, Display, "{ActorName} Terminated", GetName());
 		Status = EStatus::Terminated;
-		const double Timestamp = Now - InitialTimestamp;
-		Snapshots.Add({
-			Timestamp, TotalHits, CalculateFireRate(Timestamp, TotalHits), CalculateError(Timestamp, TotalHits)
-		});
+		Snapshots.Add(MakeSnapshot(Now - InitialTimestamp));
 
-		const FString DirTree = FPaths::Combine(FPaths::ProjectDir(),TEXT("Csv"));
-		if (FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*DirTree))
+		if (DumpCsvOnCompletion)
 		{
-			const FString FileName = "WeaponRpmStatistics_" + CsvName + "_%Y%m%d_%H%M%S.csv";
-			const FString CsvPath = FPaths::Combine(DirTree, FDateTime::Now().ToFormattedString(*FileName));
-			DumpToCsv(CsvPath);
-		}
-		else
-		{
-			if (OnCsvDumpFailed.IsBound())
+			const FString DirTree = FPaths::Combine(FPaths::ProjectDir(),TEXT("Csv"));
+			if (FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*DirTree))
+			{
+				const FString FileName = "WeaponRpmStatistics_" + CsvName + "_%Y%m%d_%H%M%S.csv";
+				const FString CsvPath = FPaths::Combine(DirTree, FDateTime::Now().ToFormattedString(*FileName));
+				DumpToCsv(CsvPath);
+			}
+			else
 			{
-				OnCsvDumpFailed.Broadcast();
+				if (OnCsvDumpFailed.IsBound())
+				{
+					OnCsvDumpFailed.Broadcast();
+				}
 			}
 		}
 
@@ -162,3 +164,16 @@ double AWeaponRpmStatistics::CalculateError(double Timestamp, int Hits) const
 	const double AbsoluteError = FMath::Abs(ExpectedRpm - ObservedFireRate);
 	return (AbsoluteError / ExpectedRpm) * 100;
 }
+
+double AWeaponRpmStatistics::CalculateDrift(double Timestamp, int Hits) const
+{
+	return Hits - ExpectedRpm * (Timestamp / 60);
+}
+
+FRpmSnapshot AWeaponRpmStatistics::MakeSnapshot(double Timestamp) const
+{
+	return {
+		Timestamp, TotalHits, CalculateFireRate(Timestamp, TotalHits), CalculateError(Timestamp, TotalHits),
+		CalculateDrift(Timestamp, TotalHits)
+	};
+}
@@ -21,6 +21,8 @@ struct FRpmSnapshot
 	int Hits;
 	double FireRate;
 	double Error;
+	// Hits received minus the hits expected by now, a drift-free weapon stays within one round
+	double Drift;
 };
 
 UCLASS()
@@ -58,22 +60,29 @@ public:
 	UPROPERTY(EditAnywhere)
 	TSoftClassPtr<UDamageType> ExpectedDamageTypeClass;
 
-	UPROPERTY(EditAnywhere, meta=(UIMin=15, ClampMin=15, UIMax=300, ClampMax=300, Units="s"))
+	// Up to a day, to measure drift over long sessions
+	UPROPERTY(EditAnywhere, meta=(UIMin=15, ClampMin=15, UIMax=86400, ClampMax=86400, Units="s"))
 	int SecondsToSample = 15;
 
 	UPROPERTY(EditAnywhere)
 	bool TakeSnapshots = false;
 
 	UPROPERTY(EditAnywhere,
-		meta=(UIMin=1, ClampMin=1, UIMax=300, ClampMax=300, Units="s", EditCondition="TakeSnapshots"))
+		meta=(UIMin=1, ClampMin=1, UIMax=3600, ClampMax=3600, Units="s", EditCondition="TakeSnapshots"))
 	int SecondsBetweenSnapshots = 15;
 
+	UPROPERTY(EditAnywhere)
+	bool DumpCsvOnCompletion = true;
+
 	UPROPERTY(EditAnywhere, meta=(UIMin=1, ClampMin=1))
 	int ExpectedRpm = 1;
 
 	UPROPERTY(VisibleInstanceOnly)
 	int TotalHits = 0;
 
+	// Set by FAggregatedRadialDamageEvent
+	TOptional<FVector> LastExplosionOrigin;
+
 	UPROPERTY(VisibleInstanceOnly)
 	TArray<FRpmSnapshot> Snapshots;
 
@@ -91,4 +100,6 @@ protected:
 
 	double CalculateFireRate(double Timestamp, int Hits) const;
 	double CalculateError(double Timestamp, int Hits) const;
+	double CalculateDrift(double Timestamp, int Hits) const;
+	FRpmSnapshot MakeSnapshot(double Timestamp) const;
 };
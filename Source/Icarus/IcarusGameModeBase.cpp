@@ -1,4 +1,12 @@
-// Stefano Famà (famastefano@gmail.com)
+﻿// Stefano Famà (famastefano@gmail.com)
 
 
 #include "IcarusGameModeBase.h"
+
+#include "ActorPoolSubsystem.h"
+
+void AIcarusGameModeBase::GetSeamlessTravelActorList(bool bToTransition, TArray<AActor*>& ActorList)
+{
+	Super::GetSeamlessTravelActorList(bToTransition, ActorList);
+	UActorPoolSubsystem::AddSeamlessTravelActors(GetWorld(), bToTransition, ActorList);
+}
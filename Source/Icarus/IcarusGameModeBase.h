@@ -13,4 +13,7 @@ UCLASS()
 class ICARUS_API AIcarusGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
+
+public:
+	virtual void GetSeamlessTravelActorList(bool bToTransition, TArray<AActor*>& ActorList) override;
 };